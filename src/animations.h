@@ -0,0 +1,20 @@
+/** \file   animations.h
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ */
+
+#include <pebble.h>
+
+/** Releases an animation from its stopped handler, the one place the platforms differ.
+ *  basalt and chalk destroy animations themselves once they stop. aplite keeps them until
+ *  animation_destroy is called; an animation stopped early was stopped by animation_destroy
+ *  so only one that ran to the end is destroyed here.
+ *  \param  animation   The animation passed to the stopped handler.
+ *  \param  finished    The finished flag passed to the stopped handler.
+ */
+static inline void animation_release_stopped(Animation* animation, bool finished) {
+#ifdef PBL_PLATFORM_APLITE
+    if (finished)
+        animation_destroy(animation);
+#endif
+}
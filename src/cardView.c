@@ -4,6 +4,7 @@
  */
 
 #include "cardView.h"
+#include "animations.h"
 
 #define ANIMATION_DURATION 250
 
@@ -11,10 +12,99 @@ typedef struct {
     void (*destroy)(void*);
     void* context;
     GColor bg;
+    int id;
+    CardView* cv;
+#if CARD_CACHE_SIZE
+    Layer* layerContent;
+    Layer* layerCapture;
+    // The cached image drawn instead of the content while the cards are moving.
+    GBitmap* bitmap;
+#endif
 } Card;
 
+static void destroy_card(Layer* layer);
+
+#if CARD_CACHE_SIZE
+static GBitmap* cache_find(CardView* cv, int id) {
+    if (id < 0) return NULL;
+    for (int i = 0; i < CARD_CACHE_SIZE; ++i) {
+        if (cv->cache[i] && cv->cacheIds[i] == id) return cv->cache[i];
+    }
+    return NULL;
+}
+
+static void cache_store(CardView* cv, int id, GBitmap* bitmap) {
+    // Replace the oldest entry once the cache is full.
+    int i = cv->cacheNext;
+    cv->cacheNext = (cv->cacheNext + 1) % CARD_CACHE_SIZE;
+    if (cv->cache[i]) gbitmap_destroy(cv->cache[i]);
+    cv->cache[i] = bitmap;
+    cv->cacheIds[i] = id;
+}
+
+static void cache_clear(CardView* cv) {
+    for (int i = 0; i < CARD_CACHE_SIZE; ++i) {
+        if (cv->cache[i]) gbitmap_destroy(cv->cache[i]);
+        cv->cache[i] = NULL;
+    }
+    cv->cacheNext = 0;
+}
+
+static GBitmap* copy_rows(GBitmap* source, GRect frame) {
+    GBitmap* copy = gbitmap_create_blank(frame.size, gbitmap_get_format(source));
+    if (!copy) return NULL;
+    uint8_t* src = gbitmap_get_data(source);
+    uint8_t* dst = gbitmap_get_data(copy);
+    uint16_t srcRow = gbitmap_get_bytes_per_row(source);
+    uint16_t dstRow = gbitmap_get_bytes_per_row(copy);
+    // Cards span the full width of the screen so whole rows can be copied.
+    for (int y = 0; y < frame.size.h; ++y) {
+        memcpy(dst + y * dstRow, src + (frame.origin.y + y) * srcRow, dstRow);
+    }
+    return copy;
+}
+
+/** Switches a card between drawing its content and drawing its cached image.
+ *  The cached image is only used if one exists for the card.
+ */
+static void card_set_cached(Layer* layer, bool cached) {
+    Card* c = layer_get_data(layer);
+    c->bitmap = cached ? cache_find(c->cv, c->id) : NULL;
+    layer_set_hidden(c->layerContent, c->bitmap != NULL);
+}
+
+static void capture_update_proc(Layer* layer, GContext* ctx) {
+    // This layer is drawn after the content, so the frame buffer holds the finished card.
+    Layer* card = *(Layer**)layer_get_data(layer);
+    Card* c = layer_get_data(card);
+    CardView* cv = c->cv;
+    // Only capture the current card at rest, and only if it will be used to animate.
+    if (cv->animation || !cv->animated || card != cv->layerCurrent || c->id < 0 || cache_find(cv, c->id))
+        return;
+    GBitmap* frameBuffer = graphics_capture_frame_buffer(ctx);
+    if (!frameBuffer)
+        return;
+    GBitmap* bitmap = copy_rows(frameBuffer, layer_get_frame(cv->layerParent));
+    graphics_release_frame_buffer(ctx, frameBuffer);
+    if (bitmap)
+        cache_store(cv, c->id, bitmap);
+}
+#else
+static void card_set_cached(Layer* layer, bool cached) {
+}
+
+static void cache_clear(CardView* cv) {
+}
+#endif
+
 static void fill_update_proc(Layer* layer, GContext* ctx) {
     Card* c = layer_get_data(layer);
+#if CARD_CACHE_SIZE
+    if (c->bitmap) {
+        graphics_draw_bitmap_in_rect(ctx, c->bitmap, layer_get_bounds(layer));
+        return;
+    }
+#endif
     graphics_context_set_fill_color(ctx, c->bg);
     graphics_fill_rect(ctx,layer_get_frame(layer), 0, GCornerNone);
 }
@@ -22,19 +112,17 @@ static void fill_update_proc(Layer* layer, GContext* ctx) {
 static void animation_stop (Animation *animation, bool finished, void* context) {
     CardView* cv = (CardView*) context;
     // Destroy the previous current card.
-    CardView_destroy_card(cv->layerCurrent);
+    destroy_card(cv->layerCurrent);
     // Make the new card current.
     cv->layerCurrent = cv->layerNext;
     cv->layerNext = NULL;
+    // The card is at rest so draw its content again.
+    card_set_cached(cv->layerCurrent, false);
     // If the animation is not finished, the new layer must be moved to the correct position.
     if (!finished) {
         layer_set_frame(cv->layerCurrent, layer_get_frame(cv->layerParent));
     }
-    // Destroy the animation only if it finished naturally on aplite
-#ifdef PBL_PLATFORM_APLITE
-    if (finished)
-        animation_destroy((Animation*)animation);
-#endif
+    animation_release_stopped(animation, finished);
     cv->animation = NULL;
 }
 
@@ -45,11 +133,18 @@ CardView* CardView_create(Window* w) {
         cv->layerNext = NULL;
         cv->layerCurrent = NULL;
         cv->animation = NULL;
+        cv->animated = true;
+#if CARD_CACHE_SIZE
+        for (int i = 0; i < CARD_CACHE_SIZE; ++i) {
+            cv->cache[i] = NULL;
+        }
+        cv->cacheNext = 0;
+#endif
     }
     return cv;
 }
 
-Layer* CardView_add_card(CardView* cv, Direction d, GColor bg, void (*destroyCallback)(void*), void* context) {
+Layer* CardView_add_card(CardView* cv, Direction d, GColor bg, int id, void (*destroyCallback)(void*), void* context) {
     // y positions for above and below the screen.
     GRect cardFrame = layer_get_frame(cv->layerParent);
     const int ypos[] = {0 - cardFrame.size.h, cardFrame.size.h};
@@ -57,38 +152,63 @@ Layer* CardView_add_card(CardView* cv, Direction d, GColor bg, void (*destroyCal
     cardFrame.origin.y = ypos[d];
     // Create the new layer with extra data for pointer to the context.
     Layer* layer = layer_create_with_data(cardFrame,sizeof(Card));
+#if CARD_CACHE_SIZE
+    GRect bounds = GRect(0, 0, cardFrame.size.w, cardFrame.size.h);
+    // The content is drawn on its own layer so it can be hidden while the cached image is used.
+    Layer* content = layer_create(bounds);
+    Layer* capture = layer_create_with_data(bounds, sizeof(Layer*));
 
-    // Ensure the layer was created.
-    if (!layer) {
+    // Ensure the layers were created.
+    if (!layer || !content || !capture) {
+        if (layer) layer_destroy(layer);
+        if (content) layer_destroy(content);
+        if (capture) layer_destroy(capture);
         return NULL;
     }
+#else
+    // Without a cache the content is drawn straight onto the card.
+    Layer* content = layer;
+    if (!layer) return NULL;
+#endif
     
     // Get the pointer to the data to store the callback and context.
     Card* card = layer_get_data(layer);
     card->destroy = destroyCallback;
     card->context = context;
+    card->id = id;
+    card->cv = cv;
     // Set the draw method and bg color of the new card.
     card->bg = bg;
     layer_set_update_proc(layer, (LayerUpdateProc) fill_update_proc);
+#if CARD_CACHE_SIZE
+    card->layerContent = content;
+    card->layerCapture = capture;
+    card->bitmap = NULL;
+    *(Layer**)layer_get_data(capture) = layer;
+    layer_set_update_proc(capture, capture_update_proc);
+    layer_add_child(layer, content);
+    layer_add_child(layer, capture);
+#endif
 
-    // If there is still an animation running destroy it.
+    // If there is still an animation running destroy it, the stopped handler
+    // will destroy the old current card and promote the moving card in its place.
     if (cv->animation)
     {
         animation_destroy((Animation*)cv->animation);
     }
     // Otherwise if the next layer hasn't begun moving onscreen destroy it.
     else if( cv->layerNext) {
-        CardView_destroy_card(cv->layerNext);
+        destroy_card(cv->layerNext);
     }
 
-    // Finally replace the layer pointer and return it.
+    // Finally replace the layer pointer and return the layer for the card's content.
     cv->layerNext = layer;
-    return layer;
+    return content;
 }
 
 int CardView_animate(CardView* cv) {
-    // Check that an animation isn't already running.
-    if (cv->animation) return 1;
+    // Check that an animation isn't already running and there is a card to show.
+    if (cv->animation || !cv->layerNext) return 1;
     // Get the target position for the new card.
     GRect target = layer_get_frame(cv->layerParent);
     // Add the new layer as a child
@@ -103,7 +223,17 @@ int CardView_animate(CardView* cv) {
     }
     else {
         layer_insert_below_sibling(cv->layerNext, cv->layerCurrent);
-        cv->animation = property_animation_create_layer_frame(cv->layerNext, NULL, &target);
+        if (cv->animated) {
+            cv->animation = property_animation_create_layer_frame(cv->layerNext, NULL, &target);
+        }
+        // Without an animation just swap the cards immediately.
+        if (!cv->animation) {
+            animation_stop(NULL, false, cv);
+            return 0;
+        }
+        // Draw both cards from the cache while they move, rather than laying out their text every frame.
+        card_set_cached(cv->layerCurrent, true);
+        card_set_cached(cv->layerNext, true);
         animation_set_duration((Animation*)cv->animation, ANIMATION_DURATION);
         animation_set_handlers((Animation*)cv->animation, (AnimationHandlers) {
                 .stopped = (AnimationStoppedHandler) animation_stop }, cv);
@@ -113,7 +243,18 @@ int CardView_animate(CardView* cv) {
     return 0;
 }
 
-void CardView_destroy_card(Layer* layer) {
+void CardView_set_animated(CardView* cv, bool animated) {
+    cv->animated = animated;
+    if (animated)
+        return;
+    // Finish any slide first, the moving cards may be drawing cached images.
+    if (cv->animation)
+        animation_destroy((Animation*)cv->animation);
+    // Cached images are only used for animation, so release the memory.
+    cache_clear(cv);
+}
+
+static void destroy_card(Layer* layer) {
     Card* c = layer_get_data(layer);
     // Just in case there is no data
     if (!c) {
@@ -125,6 +266,10 @@ void CardView_destroy_card(Layer* layer) {
     {
         c->destroy(c->context);
     }
+#if CARD_CACHE_SIZE
+    layer_destroy(c->layerCapture);
+    layer_destroy(c->layerContent);
+#endif
     layer_destroy(layer);
 }
 
@@ -134,11 +279,11 @@ void CardView_destroy(CardView* cv) {
         animation_destroy((Animation*)cv->animation);
     }
     if(cv->layerNext) {
-        CardView_destroy_card(cv->layerNext);
+        destroy_card(cv->layerNext);
     }
     if(cv->layerCurrent) {
-        CardView_destroy_card(cv->layerCurrent);
+        destroy_card(cv->layerCurrent);
     }
+    cache_clear(cv);
     free(cv);
 }
-
@@ -5,11 +5,28 @@
 
 #include <pebble.h>
 
+// Number of card images kept for animation, each is a full screen bitmap. Colour frame
+// buffers are 24 KB a card, too much to keep both cards of a slide, so only aplite caches.
+// With no cache, cards are single layers that lay out their content on every frame.
+#ifndef CARD_CACHE_SIZE
+#ifdef PBL_COLOR
+#define CARD_CACHE_SIZE 0
+#else
+#define CARD_CACHE_SIZE 2
+#endif
+#endif
+
 typedef struct {
     Layer* layerParent;
     Layer* layerCurrent;
     Layer* layerNext;
     PropertyAnimation* animation;
+    bool animated;
+#if CARD_CACHE_SIZE
+    GBitmap* cache[CARD_CACHE_SIZE];
+    int cacheIds[CARD_CACHE_SIZE];
+    int cacheNext;
+#endif
 } CardView;
 
 typedef enum {FROM_ABOVE, FROM_BELOW} Direction;
@@ -25,17 +42,15 @@ CardView* CardView_create(Window* w);
  *  \param  direction       The direction that the card should enter the screen (FROM_ABOVE or FROM_BELOW).
  *                          For the first layer to be added the direction will be ignored.
  *  \param  bg              The background color of the card.
+ *  \param  id              Identifies cards with the same content so an image of the card can be
+ *                          reused while it is animating, or -1 to never cache the card.
+ *                          Only aplite keeps a cache, elsewhere the id is ignored.
  *  \param  destroyCallback A pointer to a function that is called when the card is deleted.
  *  \param  context         A pointer that is passed to the CardDestroyCallback function.
- *  \return     A pointer to the layer 
- */
-Layer* CardView_add_card(CardView* cv, Direction d, GColor bg, void (*destroyCallback)(void*), void* context);
-
-/** Destroys a layer initialised by CardView_add_card.
- *  \param layer    A layer created by CardView_add_card, calling on any other layer
- *                  has undefined results.
+ *  \return     A pointer to the layer to add the card's content to, or NULL on failure.
+ *              Without a cache this is the card layer itself.
  */
-void CardView_destroy_card(Layer* layer);
+Layer* CardView_add_card(CardView* cv, Direction d, GColor bg, int id, void (*destroyCallback)(void*), void* context);
 
 /** Animates the transition between layers, assuming no animation is already running.
  *  \param  cv  A pointer to the CardView to animate.
@@ -43,6 +58,12 @@ void CardView_destroy_card(Layer* layer);
  */
 int CardView_animate(CardView* cv);
 
+/** Chooses whether new cards slide onscreen or simply replace the current card.
+ *  \param  cv          A pointer to the CardView to change.
+ *  \param  animated    true to slide the cards, false to swap them instantly.
+ */
+void CardView_set_animated(CardView* cv, bool animated);
+
 /** Destroys a CardView and all associated resources.
  *  \param  cv    A pointer to the CardView to destroy.
  */
@@ -7,16 +7,14 @@
 #include "gameWindow.h"
 #include "fonts.h"
 #include "cardView.h"
+#include "power.h"
+#include "layout.auto.h"
 
 #ifdef PBL_COLOR
 #define FACTIONS 10
 #else
 #define FACTIONS 3
 #endif
-#define LOGO_Y 25
-#define LOGO_HEIGHT 100
-#define TEXT_HEIGHT 50
-#define HB_TEXTHEIGHT 20
 
 #ifdef PBL_COLOR
 enum {CORP, RUNNER, ANARCH, CRIMINAL, JINTEKI, HAAS, NBN, SHAPER, WEYLAND, TUTORIAL};
@@ -67,6 +65,18 @@ static void select_click_handler(ClickRecognizerRef recognizer, void *context) {
     gameWindow_init (faction_get_color(selectedFaction), faction_get_fg(selectedFaction), clicks[selectedFaction]);
 }
 
+static void select_long_handler(ClickRecognizerRef recognizer, void *context) {
+    if (power_toggle())
+        vibes_short_pulse();
+    else
+        vibes_double_pulse();
+}
+
+static void power_changed(bool lowPower) {
+    CardView_set_animated(cardView, !lowPower);
+    gameWindow_set_low_power(lowPower);
+}
+
 static void destroy_card(void* context) {
     TextLayer** layer = context;
     int i = 0;
@@ -85,24 +95,25 @@ static int make_card(CardView* cv, Direction d) {
     const char* factionLogos[] = {"\ue005\ue602\n\ue60b\ue607", "\ue605\ue612\ue613", "\ue611\ue600"};
     const char* factionNames[] = {"CORP", "RUNNER", "TUTORIAL"};
 #endif
-    TextLayer** sublayers = malloc(sizeof(void*) * 3);
-    Layer* layer = CardView_add_card(cv, d, faction_get_color(selectedFaction), destroy_card, sublayers);
-    GRect frame = layer_get_frame(window_get_root_layer(window));
-    // Create layers for text and logo.
-    frame.origin.y = frame.size.h - TEXT_HEIGHT;
-    frame.size.h = TEXT_HEIGHT;
+    TextLayer** sublayers = calloc(3, sizeof(void*));
+    if (!sublayers) return 1;
+    Layer* layer = CardView_add_card(cv, d, faction_get_color(selectedFaction), selectedFaction, destroy_card, sublayers);
+    if (!layer) {
+        free(sublayers);
+        return 1;
+    }
+    // Create layers for text and logo, the corp and HB need room for an extra line.
+    GRect nameFrame = LAYOUT_CARD_NAME_RECT;
+    GRect logoFrame = LAYOUT_CARD_LOGO_RECT;
+    if (selectedFaction == CORP) {
+        nameFrame = LAYOUT_CARD_NAME_RECT_CORP;
+        logoFrame = LAYOUT_CARD_LOGO_RECT_CORP;
+    }
 #ifdef PBL_COLOR
-    // If the text is HB, move up for the two lines
-    if (selectedFaction == HAAS) frame.origin.y -= HB_TEXTHEIGHT;
+    if (selectedFaction == HAAS) nameFrame = LAYOUT_CARD_NAME_RECT_HAAS;
 #endif
-    // If the corp is selected move the text down to make room for the logos.
-    if (selectedFaction == CORP) frame.origin.y += LOGO_Y / 2;
-    sublayers[0] = text_layer_create(frame);
-    frame.origin.y = LOGO_Y;
-    frame.size.h = LOGO_HEIGHT;
-    // If the corp is selected move the logos up to make room for both lines.
-    if (selectedFaction == CORP) frame.origin.y-= LOGO_Y / 2;
-    sublayers[1] = text_layer_create(frame);
+    sublayers[0] = text_layer_create(nameFrame);
+    sublayers[1] = text_layer_create(logoFrame);
     // Set both text layers to transparent and centered.
     text_layer_set_background_color(sublayers[0], GColorClear);
     text_layer_set_background_color(sublayers[1], GColorClear);
@@ -137,6 +148,7 @@ static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
 
 static void click_config_provider(void *context) {
     window_single_click_subscribe(BUTTON_ID_SELECT, select_click_handler);
+    window_long_click_subscribe(BUTTON_ID_SELECT, 0, select_long_handler, NULL);
     window_single_click_subscribe(BUTTON_ID_UP, up_click_handler);
     window_single_click_subscribe(BUTTON_ID_DOWN, down_click_handler);
 }
@@ -144,15 +156,18 @@ static void click_config_provider(void *context) {
 static void window_load(Window *window) {
     fonts_load();
     cardView = CardView_create(window);
+    CardView_set_animated(cardView, !power_is_low());
     make_card(cardView, FROM_ABOVE);
 }
 
 static void window_unload(Window *window) {
-    fonts_unload();
+    // Destroy the cards before the fonts their text layers use.
     CardView_destroy(cardView);
+    fonts_unload();
 }
 
 static void init(void) {
+    power_init(power_changed);
     window = window_create();
     window_set_click_config_provider_with_context(window, click_config_provider, cardView);
     window_set_window_handlers(window, (WindowHandlers) {
@@ -166,6 +181,7 @@ static void init(void) {
 static void deinit(void) {
     APP_LOG(APP_LOG_LEVEL_INFO, "De-initializing, destroying window: %p", window);
     window_destroy(window);
+    power_deinit();
 }
 
 int main(void) {
@@ -3,37 +3,34 @@
  *  \date   8-6-2015
  */
 
+#include "animations.h"
 #include "fonts.h"
 #include "gameWindow.h"
+#include "layout.auto.h"
+#include "power.h"
+#include "tutorial.h"
 
 #define TEXT_LEN 9
 #define VALUES 2
 #define LONG_CLICK_DURATION 500
-#define MAX_CLICKS 6
-#define CLICKS_Y 19
+#define MAX_CLICKS LAYOUT_MAX_CLICKS
+#define CLICKS_Y LAYOUT_CLICKS_Y
 #define CLICKS_RADIUS 10
 #define CLICKS_THICKNESS 3
 #define CLICKS_FILL_RADIUS 5
 #define CLICKS_SIZE ((CLICKS_RADIUS * 2) + 4)
-#define CLICKS_X_OFFSET 1
-#define CREDITS_Y 49
+#define CREDITS_Y LAYOUT_CREDITS_Y
 #define CREDITS_SYMBOL_OFFSET 6
-#define SCREEN_WIDTH 144
-#define TURN_RECT GRect(0, 112, SCREEN_WIDTH, 30)
-#ifdef PBL_PLATFORM_BASALT
-#define SELECT_RECT_0 GRect(1, 14 + STATUS_BAR_LAYER_HEIGHT, SCREEN_WIDTH - 2, 30)
-#define SELECT_RECT_1 GRect(1, 58 + STATUS_BAR_LAYER_HEIGHT, SCREEN_WIDTH - 2, 42)
-#define EXIT_RECT GRect(1, 14 + STATUS_BAR_LAYER_HEIGHT, SCREEN_WIDTH - 2, 66)
-#define EXIT_OUT_RECT GRect(1, -66 + STATUS_BAR_LAYER_HEIGHT, SCREEN_WIDTH - 2, 66)
-#else
-#define SELECT_RECT_0 GRect(1, 14, SCREEN_WIDTH - 2, 30)
-#define SELECT_RECT_1 GRect(1, 58, SCREEN_WIDTH - 2, 42)
-#define EXIT_RECT GRect(1, 14, SCREEN_WIDTH - 2, 66)
-#define EXIT_OUT_RECT GRect(1, -66, SCREEN_WIDTH - 2, 66)
-#endif
+#define SCREEN_WIDTH LAYOUT_SCREEN_WIDTH
+#define TURN_RECT LAYOUT_TURN_RECT
+#define SELECT_RECT_0 LAYOUT_SELECT_RECT_0
+#define SELECT_RECT_1 LAYOUT_SELECT_RECT_1
+#define EXIT_RECT LAYOUT_EXIT_RECT
+#define EXIT_OUT_RECT LAYOUT_EXIT_OUT_RECT
 #define EXIT_ANIMATION_DURATION 1500
 #define ROUNDING 6
 #define SELECT_ANIMATION_DURATION 250
+#define TUTORIAL_INSET LAYOUT_TUTORIAL_INSET
 #define CREDSYM "\ue600"
 enum {VALUE_CLICKS = 0, VALUE_CREDITS = 1};
 
@@ -51,9 +48,16 @@ static char creditText[TEXT_LEN] = "5";
 static char turnText[TEXT_LEN] = "TURN 1";
 static GRect selectionFrame[VALUES];
 static PropertyAnimation* animationExiting = NULL;
-#ifdef PBL_PLATFORM_BASALT
-static StatusBarLayer* statusBar;
+static PropertyAnimation* animationSelecting = NULL;
+static Layer* layerExiting = NULL;
+static AppTimer* timerExiting = NULL;
+#if LAYOUT_HAS_STATUS_BAR
+static StatusBarLayer* statusBar = NULL;
 #endif
+static int tutorialSteps = 0;
+static int tutorialIndex = 0;
+static TutorialStep tutorialStep;
+static Layer* layerTutorial = NULL;
 
 static void draw_click(GContext* ctx, bool filled, bool perm, int y, int x) {
     GPoint p = GPoint(x + CLICKS_RADIUS, y + CLICKS_RADIUS);
@@ -87,6 +91,20 @@ static void exit_update_proc(Layer* layer, GContext* ctx) {
             GTextOverflowModeFill, GTextAlignmentCenter, NULL);
 }
 
+static void tutorial_update_proc(Layer* layer, GContext* ctx) {
+    GRect rect = layer_get_frame(layer);
+    rect.origin = GPointZero;
+    graphics_context_set_fill_color(ctx, s_bg);
+    graphics_context_set_text_color(ctx, s_fg);
+    graphics_context_set_stroke_color(ctx, s_fg);
+    graphics_fill_rect(ctx, rect, ROUNDING, GCornersAll);
+    graphics_draw_round_rect(ctx, rect, ROUNDING);
+    rect.origin.x += TUTORIAL_INSET;
+    rect.size.w -= TUTORIAL_INSET * 2;
+    graphics_draw_text(ctx, tutorialStep.text, fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD), rect,
+            GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+}
+
 static void draw_credit_text(GContext* ctx, const char* credits, int y) {
     GRect credFrame, symFrame;
     credFrame.size = graphics_text_layout_get_content_size(
@@ -123,7 +141,7 @@ static void selection_update_proc(Layer* layer, GContext* ctx) {
 
 static void main_update_proc(Layer* layer, GContext* ctx) {
     int t = (avClicks < totalClicks) ? totalClicks : avClicks;
-    int x = (SCREEN_WIDTH - t * CLICKS_SIZE) / 2 + CLICKS_X_OFFSET;
+    int x = LAYOUT_CLICKS_X[t];
     for (int i = 0; i < t; i++) {
         draw_click(ctx, avClicks > i, totalClicks > i, CLICKS_Y, x);
         x += CLICKS_SIZE;
@@ -135,38 +153,57 @@ static void main_update_proc(Layer* layer, GContext* ctx) {
 }
 
 static void exit_animation_stopped(Animation* animation, bool finished, void* data) {
-#ifdef PBL_PLATFORM_APLITE
-    if (finished) {
-        animation_destroy(animation);
-    }
-#endif
+    animation_release_stopped(animation, finished);
     layer_destroy((Layer*)data);
     animationExiting = NULL;
 }
 
 static void select_animation_stopped(Animation* animation, bool finished, void* context) {
-#ifdef PBL_PLATFORM_APLITE
-    if (finished) {
-        animation_destroy(animation);
-    }
-#endif
+    animation_release_stopped(animation, finished);
     *(PropertyAnimation**)context = NULL;
 }
+static void exit_timer_fired(void* data) {
+    layer_destroy(layerExiting);
+    layerExiting = NULL;
+    timerExiting = NULL;
+}
+
+/** Removes the exit message, so the next BACK press asks again rather than exiting. */
+static void cancel_exit(void) {
+    // The stopped handler destroys the exit layer and clears animationExiting.
+    if (animationExiting)
+        animation_destroy((Animation*)animationExiting);
+    if (timerExiting) {
+        app_timer_cancel(timerExiting);
+        exit_timer_fired(NULL);
+    }
+}
+
 static void reprint_text (bool markDirty) {
-    animationExiting = false;
     static int lastCredits = 0;
     static int lastTurns = 0;
+    static int lastAvClicks = 0;
+    static int lastTotalClicks = 0;
+    bool changed = false;
     if (credits != lastCredits) {
         snprintf(creditText, TEXT_LEN, "%u", credits);
         lastCredits = credits;
-        if (markDirty)
-            layer_mark_dirty(layerGraphics);
+        changed = true;
     }
     if (turns != lastTurns) {
         snprintf(turnText, TEXT_LEN, "TURN %u", turns);
         lastTurns = turns;
-        if (markDirty)
-            layer_mark_dirty(layerGraphics);
+        changed = true;
+    }
+    if (avClicks != lastAvClicks || totalClicks != lastTotalClicks) {
+        lastAvClicks = avClicks;
+        lastTotalClicks = totalClicks;
+        changed = true;
+    }
+    // Only redraw when something visible has actually changed, which also cancels a pending exit.
+    if (markDirty && changed) {
+        cancel_exit();
+        layer_mark_dirty(layerGraphics);
     }
 }
 
@@ -179,7 +216,6 @@ static void up_click_handler(ClickRecognizerRef recognizer, void *context) {
     if (selectedValue == VALUE_CLICKS) {
         avClicks++;
         avClicks = (avClicks < MAX_CLICKS) ? avClicks : MAX_CLICKS;
-        layer_mark_dirty(layerGraphics);
     }
     else if (selectedValue == VALUE_CREDITS) {
         credits++;
@@ -194,7 +230,6 @@ static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
             avClicks = 0;
             new_turn();
         }
-        layer_mark_dirty(layerGraphics);
     }
     else if (selectedValue == VALUE_CREDITS) {
         credits--;
@@ -206,6 +241,7 @@ static void down_click_handler(ClickRecognizerRef recognizer, void *context) {
 static void up_long_handler(ClickRecognizerRef recognizer, void *context) {
     if (selectedValue == VALUE_CLICKS) {
         totalClicks++;
+        totalClicks = (totalClicks < MAX_CLICKS) ? totalClicks : MAX_CLICKS;
     }
     else if (selectedValue == VALUE_CREDITS) {
         credits += 4;
@@ -224,36 +260,61 @@ static void down_long_handler(ClickRecognizerRef recognizer, void *context) {
     down_click_handler(recognizer, context);
 }
 
+static void move_selection(GRect target) {
+    // Stopping a running animation clears animationSelecting via its stopped handler.
+    if (animationSelecting != NULL)
+       animation_destroy((Animation*)animationSelecting);
+    if (!power_is_low())
+        animationSelecting = property_animation_create_layer_frame(layerSelection, NULL,
+                &target);
+    if (!animationSelecting) {
+        layer_set_frame(layerSelection, target);
+        return;
+    }
+    animation_set_curve((Animation*) animationSelecting, AnimationCurveEaseOut);
+    animation_set_duration((Animation*) animationSelecting, SELECT_ANIMATION_DURATION);
+    animation_set_handlers((Animation*) animationSelecting, (AnimationHandlers){
+            .stopped = select_animation_stopped}, &animationSelecting);
+    animation_schedule((Animation*) animationSelecting);
+}
+
 static void select_click_handler(ClickRecognizerRef recognizer, void *context) {
     selectedValue = (selectedValue + 1) % VALUES;
-    static PropertyAnimation* animation = NULL;
-
-    if (animation != NULL)
-       animation_destroy((Animation*)animation);
-    animation = property_animation_create_layer_frame(layerSelection, NULL,
-            &selectionFrame[selectedValue]);
-    animation_set_curve((Animation*) animation, AnimationCurveEaseOut);
-    animation_set_duration((Animation*) animation, SELECT_ANIMATION_DURATION);
-    animation_set_handlers((Animation*) animation, (AnimationHandlers){
-            .stopped = select_animation_stopped}, &animation);
-    animation_schedule((Animation*) animation);
+    move_selection(selectionFrame[selectedValue]);
 }
 
 static void back_click_handler(ClickRecognizerRef recognizer, void *context) {
-    if (animationExiting) {
+    if (animationExiting || timerExiting) {
         gameWindow_deinit();
     }
     else {
         Layer* layer = layer_create(EXIT_RECT);
         GRect rect = EXIT_OUT_RECT;
+        if (!layer) return;
         layer_set_update_proc(layer, exit_update_proc);
-#ifdef PBL_PLATFORM_BASALT
-        layer_insert_below_sibling(layer, status_bar_layer_get_layer(statusBar));
+#if LAYOUT_HAS_STATUS_BAR
+        if (statusBar)
+            layer_insert_below_sibling(layer, status_bar_layer_get_layer(statusBar));
+        else
+            layer_add_child(window_get_root_layer(window), layer);
 #else
         layer_add_child(window_get_root_layer(window), layer);
 #endif
+        // In low power mode show the message without moving it and remove it afterwards.
+        if (power_is_low()) {
+            timerExiting = app_timer_register(EXIT_ANIMATION_DURATION, exit_timer_fired, NULL);
+            if (timerExiting)
+                layerExiting = layer;
+            else
+                layer_destroy(layer);
+            return;
+        }
         animationExiting = property_animation_create_layer_frame(layer, NULL,
                 &rect);
+        if (!animationExiting) {
+            layer_destroy(layer);
+            return;
+        }
         animation_set_curve((Animation*) animationExiting, AnimationCurveEaseIn);
         animation_set_duration((Animation*) animationExiting, EXIT_ANIMATION_DURATION);
         animation_set_handlers((Animation*) animationExiting, (AnimationHandlers){
@@ -262,8 +323,69 @@ static void back_click_handler(ClickRecognizerRef recognizer, void *context) {
     }
 }
 
+static void tutorial_show_step(int index) {
+    // Highlighted rects and the text kept clear of them, indexed by TutorialRegion.
+    const GRect highlight[] = {GRectZero, SELECT_RECT_0, SELECT_RECT_1, LAYOUT_SELECT_RECT_TURN};
+    const GRect text[] = {LAYOUT_TUTORIAL_RECT_NONE, LAYOUT_TUTORIAL_RECT_CLICKS,
+            LAYOUT_TUTORIAL_RECT_CREDITS, LAYOUT_TUTORIAL_RECT_TURN};
+    // End the tutorial if the step can't be loaded.
+    if (!tutorial_load_step(index, &tutorialStep)) {
+        tutorialSteps = 0;
+        layer_set_hidden(layerTutorial, true);
+        layer_set_hidden(layerSelection, false);
+        return;
+    }
+    tutorialIndex = index;
+    // Drive the real counters into the state the step expects.
+    if (tutorialStep.setup) {
+        avClicks = (tutorialStep.avClicks < MAX_CLICKS) ? tutorialStep.avClicks : MAX_CLICKS;
+        totalClicks = (tutorialStep.totalClicks < MAX_CLICKS) ? tutorialStep.totalClicks : MAX_CLICKS;
+        credits = tutorialStep.credits;
+        selectedValue = tutorialStep.selected % VALUES;
+        reprint_text(true);
+    }
+    layer_set_hidden(layerSelection, tutorialStep.region == TUTORIAL_REGION_NONE);
+    if (tutorialStep.region != TUTORIAL_REGION_NONE)
+        move_selection(highlight[tutorialStep.region]);
+    layer_set_frame(layerTutorial, text[tutorialStep.region]);
+    layer_mark_dirty(layerTutorial);
+}
+
+static void tutorial_handle(ClickRecognizerRef recognizer, void *context, bool held) {
+    int pressed = click_recognizer_get_button_id(recognizer) | (held ? TUTORIAL_BUTTON_LONG : 0);
+    // Ignore everything but the button the current step asks for.
+    if (!tutorialSteps || tutorialStep.button == TUTORIAL_BUTTON_NONE
+            || (tutorialStep.button & ~TUTORIAL_BUTTON_CONSUME) != pressed)
+        return;
+    if (!(tutorialStep.button & TUTORIAL_BUTTON_CONSUME)) {
+        switch (pressed) {
+            case BUTTON_ID_UP: up_click_handler(recognizer, context); break;
+            case BUTTON_ID_DOWN: down_click_handler(recognizer, context); break;
+            case BUTTON_ID_SELECT: select_click_handler(recognizer, context); break;
+            case BUTTON_ID_UP | TUTORIAL_BUTTON_LONG: up_long_handler(recognizer, context); break;
+            case BUTTON_ID_DOWN | TUTORIAL_BUTTON_LONG: down_long_handler(recognizer, context); break;
+        }
+    }
+    tutorial_show_step(tutorialIndex + 1);
+}
+
+static void tutorial_click_handler(ClickRecognizerRef recognizer, void *context) {
+    tutorial_handle(recognizer, context, false);
+}
+
+static void tutorial_long_handler(ClickRecognizerRef recognizer, void *context) {
+    tutorial_handle(recognizer, context, true);
+}
+
 static void click_config_provider_tutorial(void *context) {
     window_single_click_subscribe(BUTTON_ID_BACK, back_click_handler);
+    if (!tutorialSteps)
+        return;
+    window_single_click_subscribe(BUTTON_ID_SELECT, tutorial_click_handler);
+    window_single_click_subscribe(BUTTON_ID_UP, tutorial_click_handler);
+    window_long_click_subscribe(BUTTON_ID_UP, LONG_CLICK_DURATION, tutorial_long_handler, NULL);
+    window_single_click_subscribe(BUTTON_ID_DOWN, tutorial_click_handler);
+    window_long_click_subscribe(BUTTON_ID_DOWN, LONG_CLICK_DURATION, tutorial_long_handler, NULL);
 }
 
 static void click_config_provider(void *context) {
@@ -278,32 +400,48 @@ static void click_config_provider(void *context) {
 static void window_load(Window *window) {
     Layer* root = window_get_root_layer(window);
     window_set_background_color(window, s_bg);
-    GRect windowFrame = layer_get_frame(root);
 
     // Add the graphics and selection layers
-#ifdef PBL_PLATFORM_BASALT
-    windowFrame.origin.y += STATUS_BAR_LAYER_HEIGHT;
-#endif
-    layerGraphics = layer_create(windowFrame);
+    layerGraphics = layer_create(LAYOUT_GRAPHICS_RECT);
     layerSelection = layer_create(selectionFrame[0]);
     layer_set_update_proc(layerGraphics, main_update_proc);
     layer_set_update_proc(layerSelection, selection_update_proc);
     layer_add_child(root, layerSelection);
     layer_add_child(root, layerGraphics);
 
-#ifdef PBL_PLATFORM_BASALT
-    statusBar = status_bar_layer_create();
-    layer_add_child(root, status_bar_layer_get_layer(statusBar));
+    if (tutorialSteps) {
+        layerTutorial = layer_create(LAYOUT_TUTORIAL_RECT_NONE);
+        layer_set_update_proc(layerTutorial, tutorial_update_proc);
+        layer_add_child(root, layerTutorial);
+        tutorial_show_step(0);
+    }
+
+#if LAYOUT_HAS_STATUS_BAR
+    // The status bar redraws every minute, so leave it out in low power mode.
+    if (!power_is_low()) {
+        statusBar = status_bar_layer_create();
+        layer_add_child(root, status_bar_layer_get_layer(statusBar));
+    }
 #endif
 }
 
 static void window_unload(Window *window) {
-    if (animationExiting)
-        property_animation_destroy(animationExiting);
+    // Both stopped handlers run from here and clear their animation pointers,
+    // the exit handler also destroys the exit layer.
+    if (animationSelecting)
+        animation_destroy((Animation*)animationSelecting);
+    cancel_exit();
     layer_destroy(layerGraphics);
     layer_destroy(layerSelection);
-#ifdef PBL_PLATFORM_BASALT
-    status_bar_layer_destroy(statusBar);
+    if (layerTutorial) {
+        layer_destroy(layerTutorial);
+        layerTutorial = NULL;
+    }
+#if LAYOUT_HAS_STATUS_BAR
+    if (statusBar) {
+        status_bar_layer_destroy(statusBar);
+        statusBar = NULL;
+    }
 #endif
 }
 
@@ -326,6 +464,8 @@ inline GColor get_highlight(GColor color) {
 
 void gameWindow_init(GColor bg, GColor fg, int clicks) {
     window = window_create();
+    // Factions without clicks run the tutorial.
+    tutorialSteps = (clicks == 0) ? tutorial_open() : 0;
     if (clicks == 0)
         window_set_click_config_provider(window, click_config_provider_tutorial);
     else
@@ -362,5 +502,21 @@ void gameWindow_deinit(void) {
     APP_LOG(APP_LOG_LEVEL_INFO, "De-initializing, destroying window: %p", window);
     window_stack_remove(window, true);
     window_destroy(window);
+    window = NULL;
+}
+
+void gameWindow_set_low_power(bool lowPower) {
+#if LAYOUT_HAS_STATUS_BAR
+    if (!window || !window_is_loaded(window))
+        return;
+    if (lowPower && statusBar) {
+        status_bar_layer_destroy(statusBar);
+        statusBar = NULL;
+    }
+    else if (!lowPower && !statusBar) {
+        statusBar = status_bar_layer_create();
+        layer_add_child(window_get_root_layer(window), status_bar_layer_get_layer(statusBar));
+    }
+#endif
 }
 
@@ -8,3 +8,8 @@
 void gameWindow_init(GColor bg, GColor fg, int clicks);
 
 void gameWindow_deinit(void);
+
+/** Switches the game window between its normal and low power rendering.
+ *  \param  lowPower    true to drop animations and the status bar.
+ */
+void gameWindow_set_low_power(bool lowPower);
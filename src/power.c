@@ -0,0 +1,55 @@
+/** \file   power.c
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ */
+
+#include "power.h"
+
+#define PERSIST_KEY_LOW_POWER 1
+#define LOW_BATTERY_PERCENT 20
+
+static bool s_forced = false;
+static bool s_battery = false;
+static void (*s_handler)(bool) = NULL;
+
+static void set_state(bool forced, bool battery) {
+    bool wasLow = power_is_low();
+    s_forced = forced;
+    s_battery = battery;
+    if (s_handler && power_is_low() != wasLow) {
+        s_handler(power_is_low());
+    }
+}
+
+static bool battery_is_low(BatteryChargeState charge) {
+    return !charge.is_charging && charge.charge_percent <= LOW_BATTERY_PERCENT;
+}
+
+static void battery_handler(BatteryChargeState charge) {
+    set_state(s_forced, battery_is_low(charge));
+}
+
+void power_init(void (*handler)(bool lowPower)) {
+    s_handler = handler;
+    s_forced = persist_exists(PERSIST_KEY_LOW_POWER) && persist_read_bool(PERSIST_KEY_LOW_POWER);
+    s_battery = battery_is_low(battery_state_service_peek());
+    battery_state_service_subscribe(battery_handler);
+}
+
+void power_deinit(void) {
+    battery_state_service_unsubscribe();
+    s_handler = NULL;
+}
+
+bool power_is_low(void) {
+    return s_forced || s_battery;
+}
+
+bool power_toggle(void) {
+    // Switching off would not be visible until the battery recovers, so refuse instead.
+    if (s_battery)
+        return false;
+    persist_write_bool(PERSIST_KEY_LOW_POWER, !s_forced);
+    set_state(!s_forced, s_battery);
+    return true;
+}
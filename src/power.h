@@ -0,0 +1,26 @@
+/** \file   power.h
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ */
+
+#include <pebble.h>
+
+/** Restores the saved low power setting and starts watching the battery.
+ *  \param  handler A pointer to a function that is called whenever low power mode
+ *                  is switched on or off, may be NULL.
+ */
+void power_init(void (*handler)(bool lowPower));
+
+/** Stops watching the battery. */
+void power_deinit(void);
+
+/** \return true if the app should avoid animations and unnecessary redraws,
+ *          either because the user chose to or the battery is low.
+ */
+bool power_is_low(void);
+
+/** Switches the user selected low power setting on or off and saves it.
+ *  Does nothing while a low battery holds the app in low power mode.
+ *  \return true if the setting was changed.
+ */
+bool power_toggle(void);
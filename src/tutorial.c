@@ -0,0 +1,53 @@
+/** \file   tutorial.c
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ */
+
+#include "tutorial.h"
+
+// The resource layout is described in tools/tutorial.py.
+#define VERSION 1
+#define HEADER_SIZE 6
+#define OFFSET_SIZE 2
+#define STEP_HEADER_SIZE 8
+#define FLAG_SETUP 0x01
+enum {STEP_BUTTON, STEP_REGION, STEP_FLAGS, STEP_AV_CLICKS, STEP_TOTAL_CLICKS, STEP_CREDITS, STEP_SELECTED, STEP_TEXT_LEN};
+
+static ResHandle handle;
+static int steps = 0;
+
+int tutorial_open(void) {
+    uint8_t header[HEADER_SIZE];
+    handle = resource_get_handle(RESOURCE_ID_TUTORIAL);
+    steps = 0;
+    if (resource_load_byte_range(handle, 0, header, HEADER_SIZE) == HEADER_SIZE
+            && memcmp(header, "TUT", 3) == 0 && header[3] == VERSION) {
+        steps = header[4];
+    }
+    return steps;
+}
+
+bool tutorial_load_step(int index, TutorialStep* step) {
+    uint8_t buffer[STEP_HEADER_SIZE + TUTORIAL_TEXT_LEN];
+    if (index < 0 || index >= steps)
+        return false;
+    // Find the step, then read its header and text together.
+    if (resource_load_byte_range(handle, HEADER_SIZE + index * OFFSET_SIZE, buffer, OFFSET_SIZE) != OFFSET_SIZE)
+        return false;
+    uint32_t offset = buffer[0] | (buffer[1] << 8);
+    size_t length = resource_load_byte_range(handle, offset, buffer, sizeof(buffer));
+    if (length < STEP_HEADER_SIZE || STEP_HEADER_SIZE + buffer[STEP_TEXT_LEN] > length
+            || buffer[STEP_REGION] > TUTORIAL_REGION_TURN)
+        return false;
+
+    step->button = buffer[STEP_BUTTON];
+    step->region = buffer[STEP_REGION];
+    step->setup = buffer[STEP_FLAGS] & FLAG_SETUP;
+    step->avClicks = buffer[STEP_AV_CLICKS];
+    step->totalClicks = buffer[STEP_TOTAL_CLICKS];
+    step->credits = buffer[STEP_CREDITS];
+    step->selected = buffer[STEP_SELECTED];
+    memcpy(step->text, &buffer[STEP_HEADER_SIZE], buffer[STEP_TEXT_LEN]);
+    step->text[buffer[STEP_TEXT_LEN]] = '\0';
+    return true;
+}
@@ -0,0 +1,37 @@
+/** \file   tutorial.h
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ */
+
+#include <pebble.h>
+
+#define TUTORIAL_TEXT_LEN 64
+// Flags combined with the ButtonId a step expects.
+#define TUTORIAL_BUTTON_LONG 0x10
+#define TUTORIAL_BUTTON_CONSUME 0x20
+#define TUTORIAL_BUTTON_NONE 0xFF
+
+typedef enum {TUTORIAL_REGION_NONE, TUTORIAL_REGION_CLICKS, TUTORIAL_REGION_CREDITS, TUTORIAL_REGION_TURN} TutorialRegion;
+
+typedef struct {
+    // The ButtonId to press, with TUTORIAL_BUTTON_LONG if it must be held and
+    // TUTORIAL_BUTTON_CONSUME if the press is not passed to the game, or TUTORIAL_BUTTON_NONE.
+    uint8_t button;
+    TutorialRegion region;
+    // If setup is true the game's values are set to these before the step is shown.
+    bool setup;
+    int avClicks, totalClicks, credits, selected;
+    char text[TUTORIAL_TEXT_LEN + 1];
+} TutorialStep;
+
+/** Opens the tutorial resource and checks its header.
+ *  \return The number of steps in the tutorial, 0 if the resource is invalid.
+ */
+int tutorial_open(void);
+
+/** Loads a single step from the tutorial resource, nothing else is kept in memory.
+ *  \param  index   The step to load, from 0 to the value returned by tutorial_open.
+ *  \param  step    A pointer to the TutorialStep to fill.
+ *  \return         true on success, false if the step doesn't exist or is invalid.
+ */
+bool tutorial_load_step(int index, TutorialStep* step);
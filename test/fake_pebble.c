@@ -0,0 +1,1033 @@
+/** \file   fake_pebble.c
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ *
+ *  Host implementation of the parts of the Pebble API used by the app.
+ *  Destroyed objects are poisoned and held back from the real heap for a while,
+ *  so any later use through a stale pointer is reported instead of silently working.
+ */
+
+#define FAKE_PEBBLE_IMPL
+#include <stdarg.h>
+#include "fake_pebble.h"
+#include "layout.auto.h"
+
+#define MAGIC_LIVE 0x4C495645u
+#define MAGIC_DEAD 0xDEADDEADu
+#define QUARANTINE 8192
+#define FRAME_MS 33
+#define MINUTE_MS 60000
+#define MAX_WINDOWS 8
+#define MAX_PERSIST 16
+#define MAX_ERRORS_PRINTED 20
+
+typedef struct {
+    uint32_t magic;
+    FakeKind kind;
+    size_t size;
+} Header;
+
+typedef enum {LAYER_PLAIN, LAYER_ROOT, LAYER_TEXT, LAYER_STATUS_BAR} LayerType;
+
+struct Layer {
+    Header header;
+    LayerType type;
+    GRect frame;
+    bool hidden;
+    Layer* parent;
+    Layer* children;
+    Layer* next;
+    LayerUpdateProc update;
+    void* data;
+};
+
+struct TextLayer {
+    Layer layer;
+    const char* text;
+    GFont font;
+};
+
+struct StatusBarLayer {
+    Layer layer;
+};
+
+struct Window {
+    Header header;
+    Layer* root;
+    WindowHandlers handlers;
+    ClickConfigProvider provider;
+    void* providerContext;
+    bool hasContext;
+    bool loaded;
+    ClickHandler single[NUM_BUTTONS];
+    ClickHandler longDown[NUM_BUTTONS];
+};
+
+struct Animation {
+    Header header;
+    Animation* next;
+    Layer* layer;
+    GRect from, to;
+    bool hasFrom;
+    uint32_t duration;
+    AnimationHandlers handlers;
+    void* context;
+    bool scheduled;
+    uint32_t start;
+};
+
+struct GBitmap {
+    Header header;
+    GSize size;
+    GBitmapFormat format;
+    uint16_t bytesPerRow;
+    uint8_t* data;
+};
+
+struct AppTimer {
+    Header header;
+    AppTimer* next;
+    uint32_t due;
+    AppTimerCallback callback;
+    void* data;
+};
+
+struct FakeFont {
+    Header header;
+};
+
+struct GContext {
+    bool captured;
+};
+
+typedef struct {
+    ButtonId button;
+} Recognizer;
+
+static FakeStats stats;
+static int live[FAKE_KINDS];
+static int errors = 0;
+static void* quarantine[QUARANTINE];
+static int quarantineNext = 0;
+static bool dirty = false;
+// Set when the minute changes, the status bar redraws its clock.
+static bool minuteTick = false;
+static bool (*powerProbe)(void) = NULL;
+static size_t heapPeak = 0;
+
+static Window* stack[MAX_WINDOWS];
+static int stackDepth = 0;
+static Window* configuring = NULL;
+
+static Animation* animations = NULL;
+static AppTimer* timers = NULL;
+
+static BatteryChargeState battery = {100, false, false};
+static BatteryStateHandler batteryHandler = NULL;
+
+static struct { uint32_t key; bool value; } persist[MAX_PERSIST];
+static int persistCount = 0;
+
+static struct GContext context;
+static uint8_t frameBufferData[LAYOUT_SCREEN_WIDTH * LAYOUT_SCREEN_HEIGHT];
+static GBitmap frameBuffer;
+static struct FakeFont systemFont = {{MAGIC_LIVE, FAKE_FONT, 0}};
+
+static const char* kindNames[FAKE_KINDS] = {"heap blocks", "layers", "windows", "animations", "bitmaps", "timers", "fonts"};
+
+void fake_error(const char* fmt, ...) {
+    if (errors++ < MAX_ERRORS_PRINTED) {
+        va_list args;
+        va_start(args, fmt);
+        fprintf(stderr, "[%u ms] ", stats.now);
+        vfprintf(stderr, fmt, args);
+        fputc('\n', stderr);
+        va_end(args);
+    }
+}
+
+int fake_errors(void) {
+    return errors;
+}
+
+const FakeStats* fake_stats(void) {
+    return &stats;
+}
+
+size_t fake_take_heap_peak(void) {
+    size_t peak = heapPeak;
+    heapPeak = stats.heapBytes;
+    return peak;
+}
+
+int fake_live(FakeKind kind) {
+    return live[kind];
+}
+
+const char* fake_kind_name(FakeKind kind) {
+    return kindNames[kind];
+}
+
+int fake_stack_depth(void) {
+    return stackDepth;
+}
+
+bool fake_battery_subscribed(void) {
+    return batteryHandler != NULL;
+}
+
+void fake_set_power_probe(bool (*isLow)(void)) {
+    powerProbe = isLow;
+}
+
+static FakeEnergy* energy(void) {
+    return &stats.energy[powerProbe && powerProbe()];
+}
+
+/* Object tracking. */
+
+static void* object_create(FakeKind kind, size_t size) {
+    Header* h = calloc(1, size);
+    if (!h) {
+        fake_error("host out of memory");
+        exit(2);
+    }
+    h->magic = MAGIC_LIVE;
+    h->kind = kind;
+    h->size = size;
+    live[kind]++;
+    stats.heapBytes += size;
+    if (stats.heapBytes > stats.peakHeapBytes) stats.peakHeapBytes = stats.heapBytes;
+    if (stats.heapBytes > heapPeak) heapPeak = stats.heapBytes;
+    if (kind == FAKE_LAYER && live[kind] > stats.peakLayers) stats.peakLayers = live[kind];
+    if (kind == FAKE_ANIMATION && live[kind] > stats.peakAnimations) stats.peakAnimations = live[kind];
+    return h;
+}
+
+/** \return true if the object is alive and of the expected kind, otherwise reports the misuse. */
+static bool object_check(const void* object, FakeKind kind, const char* api) {
+    const Header* h = object;
+    if (!h) {
+        fake_error("%s: NULL %s", api, kindNames[kind]);
+        return false;
+    }
+    if (h->magic == MAGIC_DEAD) {
+        fake_error("%s: use after free of one of the %s", api, kindNames[kind]);
+        return false;
+    }
+    if (h->magic != MAGIC_LIVE || h->kind != kind) {
+        fake_error("%s: invalid pointer to one of the %s", api, kindNames[kind]);
+        return false;
+    }
+    return true;
+}
+
+static bool object_alive(const void* object) {
+    return ((const Header*)object)->magic == MAGIC_LIVE;
+}
+
+static void object_destroy(void* object) {
+    Header* h = object;
+    h->magic = MAGIC_DEAD;
+    live[h->kind]--;
+    stats.heapBytes -= h->size;
+    // Keep the memory poisoned for a while so stale pointers are caught.
+    free(quarantine[quarantineNext]);
+    quarantine[quarantineNext] = object;
+    quarantineNext = (quarantineNext + 1) % QUARANTINE;
+}
+
+void* fake_malloc(size_t size) {
+    Header* h = object_create(FAKE_HEAP, sizeof(Header) + size);
+    return h + 1;
+}
+
+void* fake_calloc(size_t count, size_t size) {
+    return fake_malloc(count * size);
+}
+
+void fake_free(void* ptr) {
+    if (!ptr) return;
+    Header* h = (Header*)ptr - 1;
+    if (object_check(h, FAKE_HEAP, "free"))
+        object_destroy(h);
+}
+
+/* Layers. */
+
+static bool layer_check(const Layer* layer, const char* api) {
+    return object_check(layer, FAKE_LAYER, api);
+}
+
+static void layer_init(Layer* layer, LayerType type, GRect frame) {
+    layer->type = type;
+    layer->frame = frame;
+}
+
+Layer* layer_create_with_data(GRect frame, size_t data_size) {
+    Layer* layer = object_create(FAKE_LAYER, sizeof(Layer) + data_size);
+    layer_init(layer, LAYER_PLAIN, frame);
+    layer->data = data_size ? (void*)(layer + 1) : NULL;
+    return layer;
+}
+
+Layer* layer_create(GRect frame) {
+    return layer_create_with_data(frame, 0);
+}
+
+void layer_remove_from_parent(Layer* layer) {
+    if (!layer_check(layer, "layer_remove_from_parent") || !layer->parent)
+        return;
+    Layer** link = &layer->parent->children;
+    while (*link && *link != layer) link = &(*link)->next;
+    if (*link) *link = layer->next;
+    layer->parent = NULL;
+    layer->next = NULL;
+    dirty = true;
+}
+
+static void layer_release(Layer* layer) {
+    layer_remove_from_parent(layer);
+    // Children are left without a parent, as on the watch.
+    for (Layer* child = layer->children; child; ) {
+        Layer* next = child->next;
+        if (layer_check(child, "layer_destroy (child)")) {
+            child->parent = NULL;
+            child->next = NULL;
+        }
+        child = next;
+    }
+    object_destroy(layer);
+}
+
+void layer_destroy(Layer* layer) {
+    if (!layer_check(layer, "layer_destroy"))
+        return;
+    if (layer->type != LAYER_PLAIN) {
+        fake_error("layer_destroy: called on a text, status bar or window layer");
+        return;
+    }
+    layer_release(layer);
+}
+
+void* layer_get_data(const Layer* layer) {
+    return layer_check(layer, "layer_get_data") ? layer->data : NULL;
+}
+
+GRect layer_get_frame(const Layer* layer) {
+    return layer_check(layer, "layer_get_frame") ? layer->frame : GRectZero;
+}
+
+GRect layer_get_bounds(const Layer* layer) {
+    if (!layer_check(layer, "layer_get_bounds"))
+        return GRectZero;
+    return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+void layer_set_frame(Layer* layer, GRect frame) {
+    if (!layer_check(layer, "layer_set_frame"))
+        return;
+    layer->frame = frame;
+    dirty = true;
+}
+
+void layer_set_update_proc(Layer* layer, LayerUpdateProc update_proc) {
+    if (layer_check(layer, "layer_set_update_proc"))
+        layer->update = update_proc;
+}
+
+void layer_add_child(Layer* parent, Layer* child) {
+    if (!layer_check(parent, "layer_add_child (parent)") || !layer_check(child, "layer_add_child (child)"))
+        return;
+    layer_remove_from_parent(child);
+    Layer** link = &parent->children;
+    while (*link) link = &(*link)->next;
+    *link = child;
+    child->parent = parent;
+    dirty = true;
+}
+
+void layer_insert_below_sibling(Layer* layer, Layer* below) {
+    if (!layer_check(layer, "layer_insert_below_sibling") || !layer_check(below, "layer_insert_below_sibling (sibling)"))
+        return;
+    if (!below->parent) {
+        fake_error("layer_insert_below_sibling: sibling has no parent");
+        return;
+    }
+    layer_remove_from_parent(layer);
+    Layer** link = &below->parent->children;
+    while (*link != below) link = &(*link)->next;
+    layer->next = below;
+    *link = layer;
+    layer->parent = below->parent;
+    dirty = true;
+}
+
+void layer_mark_dirty(Layer* layer) {
+    if (layer_check(layer, "layer_mark_dirty"))
+        dirty = true;
+}
+
+void layer_set_hidden(Layer* layer, bool hidden) {
+    if (!layer_check(layer, "layer_set_hidden"))
+        return;
+    if (layer->hidden != hidden) dirty = true;
+    layer->hidden = hidden;
+}
+
+TextLayer* text_layer_create(GRect frame) {
+    TextLayer* text = object_create(FAKE_LAYER, sizeof(TextLayer));
+    layer_init(&text->layer, LAYER_TEXT, frame);
+    text->font = &systemFont;
+    return text;
+}
+
+static bool text_check(TextLayer* text, const char* api) {
+    if (!layer_check(&text->layer, api))
+        return false;
+    if (text->layer.type != LAYER_TEXT) {
+        fake_error("%s: not a text layer", api);
+        return false;
+    }
+    return true;
+}
+
+void text_layer_destroy(TextLayer* text) {
+    if (text_check(text, "text_layer_destroy"))
+        layer_release(&text->layer);
+}
+
+Layer* text_layer_get_layer(TextLayer* text) {
+    return text_check(text, "text_layer_get_layer") ? &text->layer : NULL;
+}
+
+void text_layer_set_text(TextLayer* text, const char* string) {
+    if (!text_check(text, "text_layer_set_text"))
+        return;
+    text->text = string;
+    dirty = true;
+}
+
+void text_layer_set_font(TextLayer* text, GFont font) {
+    if (text_check(text, "text_layer_set_font") && object_check(font, FAKE_FONT, "text_layer_set_font"))
+        text->font = font;
+}
+
+void text_layer_set_text_color(TextLayer* text, GColor color) {
+    text_check(text, "text_layer_set_text_color");
+}
+
+void text_layer_set_background_color(TextLayer* text, GColor color) {
+    text_check(text, "text_layer_set_background_color");
+}
+
+void text_layer_set_text_alignment(TextLayer* text, GTextAlignment alignment) {
+    text_check(text, "text_layer_set_text_alignment");
+}
+
+void text_layer_set_overflow_mode(TextLayer* text, GTextOverflowMode mode) {
+    text_check(text, "text_layer_set_overflow_mode");
+}
+
+StatusBarLayer* status_bar_layer_create(void) {
+    StatusBarLayer* bar = object_create(FAKE_LAYER, sizeof(StatusBarLayer));
+    layer_init(&bar->layer, LAYER_STATUS_BAR, GRect(0, 0, LAYOUT_SCREEN_WIDTH, STATUS_BAR_LAYER_HEIGHT));
+    return bar;
+}
+
+void status_bar_layer_destroy(StatusBarLayer* bar) {
+    if (layer_check(&bar->layer, "status_bar_layer_destroy"))
+        layer_release(&bar->layer);
+}
+
+Layer* status_bar_layer_get_layer(StatusBarLayer* bar) {
+    return layer_check(&bar->layer, "status_bar_layer_get_layer") ? &bar->layer : NULL;
+}
+
+/* Drawing. */
+
+static void draw_layer(Layer* layer, bool sliding) {
+    if (!layer_check(layer, "render (destroyed layer left in the tree)") || layer->hidden)
+        return;
+    unsigned long textLayouts = stats.textLayouts;
+    switch (layer->type) {
+        case LAYER_TEXT: {
+            TextLayer* text = (TextLayer*)layer;
+            if (text->text && object_check(text->font, FAKE_FONT, "render text layer"))
+                stats.textLayouts++;
+            break;
+        }
+        case LAYER_STATUS_BAR:
+            stats.textLayouts++;
+            break;
+        default:
+            if (layer->update)
+                layer->update(layer, &context);
+    }
+    if (sliding) stats.slideTextLayouts += stats.textLayouts - textLayouts;
+    for (Layer* child = layer->children; child; child = child->next) {
+        draw_layer(child, sliding);
+        if (!object_alive(child)) {
+            fake_error("render: layer destroyed while drawing");
+            return;
+        }
+    }
+}
+
+static bool has_status_bar(const Layer* layer) {
+    if (layer->hidden)
+        return false;
+    if (layer->type == LAYER_STATUS_BAR)
+        return true;
+    for (const Layer* child = layer->children; child; child = child->next) {
+        if (has_status_bar(child)) return true;
+    }
+    return false;
+}
+
+static bool is_exit_toast(const Animation* a) {
+    GRect out = LAYOUT_EXIT_OUT_RECT;
+    return memcmp(&a->to, &out, sizeof(GRect)) == 0;
+}
+
+/** \return The reason for the next frame, for the energy report. */
+static FakeFrames* frame_reason(bool sliding) {
+    FakeEnergy* e = energy();
+    if (sliding)
+        return &e->slide;
+    for (Animation* a = animations; a; a = a->next) {
+        if (is_exit_toast(a)) return &e->exitToast;
+    }
+    if (animations)
+        return &e->animation;
+    if (!dirty)
+        return &e->statusBar;
+    return &e->input;
+}
+
+static void render(void) {
+    if (!stackDepth)
+        return;
+    Window* top = stack[stackDepth - 1];
+    if (minuteTick && has_status_bar(top->root)) {
+        // The clock only changes on a frame that would not be drawn anyway.
+        if (!dirty) energy()->wakeups++;
+    }
+    else if (!dirty) {
+        minuteTick = false;
+        return;
+    }
+    minuteTick = false;
+    // The faction menu is the only window while nothing else is pushed.
+    bool sliding = stackDepth == 1 && animations != NULL;
+    FakeFrames* reason = frame_reason(sliding);
+    unsigned long textLayouts = stats.textLayouts, fills = stats.fills, bitmaps = stats.bitmapDraws;
+    dirty = false;
+    stats.frames++;
+    draw_layer(top->root, sliding);
+    reason->frames++;
+    reason->textLayouts += stats.textLayouts - textLayouts;
+    reason->fills += stats.fills - fills;
+    reason->bitmapDraws += stats.bitmapDraws - bitmaps;
+    if (sliding) {
+        stats.slideFrames++;
+        stats.slideFills += stats.fills - fills;
+        stats.slideBitmapDraws += stats.bitmapDraws - bitmaps;
+    }
+}
+
+void graphics_context_set_fill_color(GContext* ctx, GColor color) {}
+void graphics_context_set_stroke_color(GContext* ctx, GColor color) {}
+void graphics_context_set_text_color(GContext* ctx, GColor color) {}
+void graphics_context_set_stroke_width(GContext* ctx, uint8_t stroke_width) {}
+
+void graphics_fill_rect(GContext* ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {
+    stats.fills++;
+}
+
+void graphics_draw_round_rect(GContext* ctx, GRect rect, uint16_t radius) {}
+
+void graphics_fill_circle(GContext* ctx, GPoint p, uint16_t radius) {
+    stats.fills++;
+}
+
+void graphics_draw_circle(GContext* ctx, GPoint p, uint16_t radius) {}
+
+void graphics_draw_text(GContext* ctx, const char* text, GFont font, GRect box,
+        GTextOverflowMode overflow_mode, GTextAlignment alignment, void* layout) {
+    if (object_check(font, FAKE_FONT, "graphics_draw_text"))
+        stats.textLayouts++;
+}
+
+GSize graphics_text_layout_get_content_size(const char* text, GFont font, GRect box,
+        GTextOverflowMode overflow_mode, GTextAlignment alignment) {
+    if (!object_check(font, FAKE_FONT, "graphics_text_layout_get_content_size"))
+        return GSize(0, 0);
+    stats.textLayouts++;
+    return GSize(strlen(text) * 10, 20);
+}
+
+static bool bitmap_check(const GBitmap* bitmap, const char* api) {
+    return bitmap == &frameBuffer || object_check(bitmap, FAKE_BITMAP, api);
+}
+
+void graphics_draw_bitmap_in_rect(GContext* ctx, const GBitmap* bitmap, GRect rect) {
+    if (bitmap_check(bitmap, "graphics_draw_bitmap_in_rect"))
+        stats.bitmapDraws++;
+}
+
+GBitmap* graphics_capture_frame_buffer(GContext* ctx) {
+    if (ctx->captured) {
+        fake_error("graphics_capture_frame_buffer: already captured");
+        return NULL;
+    }
+    ctx->captured = true;
+    stats.captures++;
+#ifdef PBL_PLATFORM_APLITE
+    frameBuffer.format = GBitmapFormat1Bit;
+    frameBuffer.bytesPerRow = ((LAYOUT_SCREEN_WIDTH + 31) / 32) * 4;
+#else
+    frameBuffer.format = GBitmapFormat8Bit;
+    frameBuffer.bytesPerRow = LAYOUT_SCREEN_WIDTH;
+#endif
+    frameBuffer.size = GSize(LAYOUT_SCREEN_WIDTH, LAYOUT_SCREEN_HEIGHT);
+    frameBuffer.data = frameBufferData;
+    return &frameBuffer;
+}
+
+bool graphics_release_frame_buffer(GContext* ctx, GBitmap* buffer) {
+    if (!ctx->captured || buffer != &frameBuffer) {
+        fake_error("graphics_release_frame_buffer: not captured");
+        return false;
+    }
+    ctx->captured = false;
+    return true;
+}
+
+GBitmap* gbitmap_create_blank(GSize size, GBitmapFormat format) {
+    uint16_t bytesPerRow = (format == GBitmapFormat1Bit) ? ((size.w + 31) / 32) * 4 : size.w;
+    GBitmap* bitmap = object_create(FAKE_BITMAP, sizeof(GBitmap) + bytesPerRow * size.h);
+    bitmap->size = size;
+    bitmap->format = format;
+    bitmap->bytesPerRow = bytesPerRow;
+    bitmap->data = (uint8_t*)(bitmap + 1);
+    return bitmap;
+}
+
+void gbitmap_destroy(GBitmap* bitmap) {
+    if (object_check(bitmap, FAKE_BITMAP, "gbitmap_destroy"))
+        object_destroy(bitmap);
+}
+
+uint8_t* gbitmap_get_data(const GBitmap* bitmap) {
+    return bitmap_check(bitmap, "gbitmap_get_data") ? bitmap->data : NULL;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap* bitmap) {
+    return bitmap_check(bitmap, "gbitmap_get_bytes_per_row") ? bitmap->bytesPerRow : 0;
+}
+
+GBitmapFormat gbitmap_get_format(const GBitmap* bitmap) {
+    return bitmap_check(bitmap, "gbitmap_get_format") ? bitmap->format : GBitmapFormat1Bit;
+}
+
+/* Windows and clicks. */
+
+static bool window_check(const Window* window, const char* api) {
+    return object_check(window, FAKE_WINDOW, api);
+}
+
+Window* window_create(void) {
+    Window* window = object_create(FAKE_WINDOW, sizeof(Window));
+    window->root = object_create(FAKE_LAYER, sizeof(Layer));
+    layer_init(window->root, LAYER_ROOT, GRect(0, 0, LAYOUT_SCREEN_WIDTH, LAYOUT_SCREEN_HEIGHT));
+    return window;
+}
+
+void window_destroy(Window* window) {
+    if (!window_check(window, "window_destroy"))
+        return;
+    window_stack_remove(window, false);
+    layer_release(window->root);
+    object_destroy(window);
+}
+
+Layer* window_get_root_layer(const Window* window) {
+    return window_check(window, "window_get_root_layer") ? window->root : NULL;
+}
+
+void window_set_window_handlers(Window* window, WindowHandlers handlers) {
+    if (window_check(window, "window_set_window_handlers"))
+        window->handlers = handlers;
+}
+
+void window_set_click_config_provider_with_context(Window* window, ClickConfigProvider provider, void* context) {
+    if (!window_check(window, "window_set_click_config_provider"))
+        return;
+    window->provider = provider;
+    window->providerContext = context;
+    window->hasContext = true;
+}
+
+void window_set_click_config_provider(Window* window, ClickConfigProvider provider) {
+    window_set_click_config_provider_with_context(window, provider, NULL);
+    window->hasContext = false;
+}
+
+void window_set_background_color(Window* window, GColor color) {
+    window_check(window, "window_set_background_color");
+}
+
+bool window_is_loaded(Window* window) {
+    return window_check(window, "window_is_loaded") && window->loaded;
+}
+
+static void configure_clicks(Window* window) {
+    memset(window->single, 0, sizeof(window->single));
+    memset(window->longDown, 0, sizeof(window->longDown));
+    if (!window->provider)
+        return;
+    configuring = window;
+    window->provider(window->hasContext ? window->providerContext : window);
+    configuring = NULL;
+}
+
+void window_stack_push(Window* window, bool animated) {
+    if (!window_check(window, "window_stack_push"))
+        return;
+    for (int i = 0; i < stackDepth; ++i) {
+        if (stack[i] == window) return;
+    }
+    if (stackDepth == MAX_WINDOWS) {
+        fake_error("window_stack_push: too many windows");
+        return;
+    }
+    stack[stackDepth++] = window;
+    window->loaded = true;
+    if (window->handlers.load) window->handlers.load(window);
+    configure_clicks(window);
+    dirty = true;
+}
+
+Window* window_stack_remove(Window* window, bool animated) {
+    if (!window_check(window, "window_stack_remove"))
+        return NULL;
+    int i = 0;
+    while (i < stackDepth && stack[i] != window) ++i;
+    if (i == stackDepth)
+        return NULL;
+    for (; i < stackDepth - 1; ++i) stack[i] = stack[i + 1];
+    stackDepth--;
+    if (window->handlers.unload) window->handlers.unload(window);
+    window->loaded = false;
+    if (stackDepth) configure_clicks(stack[stackDepth - 1]);
+    dirty = true;
+    return window;
+}
+
+void window_single_click_subscribe(ButtonId button, ClickHandler handler) {
+    if (!configuring) {
+        fake_error("window_single_click_subscribe: outside a click config provider");
+        return;
+    }
+    configuring->single[button] = handler;
+}
+
+void window_long_click_subscribe(ButtonId button, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler) {
+    if (!configuring) {
+        fake_error("window_long_click_subscribe: outside a click config provider");
+        return;
+    }
+    configuring->longDown[button] = down_handler;
+}
+
+ButtonId click_recognizer_get_button_id(ClickRecognizerRef recognizer) {
+    return ((Recognizer*)recognizer)->button;
+}
+
+void fake_press(ButtonId button, bool held) {
+    if (!stackDepth)
+        return;
+    Window* top = stack[stackDepth - 1];
+    Recognizer recognizer = {button};
+    void* ctx = top->hasContext ? top->providerContext : top;
+    ClickHandler handler = (held && top->longDown[button]) ? top->longDown[button] : top->single[button];
+    energy()->wakeups++;
+    if (handler)
+        handler(&recognizer, ctx);
+    else if (button == BUTTON_ID_BACK)
+        window_stack_remove(top, true);
+}
+
+/* Animations. */
+
+static bool animation_check(const Animation* animation, const char* api) {
+    return object_check(animation, FAKE_ANIMATION, api);
+}
+
+PropertyAnimation* property_animation_create_layer_frame(Layer* layer, GRect* from_frame, GRect* to_frame) {
+    if (!layer_check(layer, "property_animation_create_layer_frame"))
+        return NULL;
+    Animation* animation = object_create(FAKE_ANIMATION, sizeof(Animation));
+    animation->layer = layer;
+    animation->hasFrom = from_frame != NULL;
+    if (from_frame) animation->from = *from_frame;
+    animation->to = to_frame ? *to_frame : layer->frame;
+    animation->duration = 250;
+    return animation;
+}
+
+static void animation_unlink(Animation* animation) {
+    Animation** link = &animations;
+    while (*link && *link != animation) link = &(*link)->next;
+    if (*link) *link = animation->next;
+    animation->next = NULL;
+}
+
+/** Stops a scheduled animation and calls its stopped handler, then frees it if the
+ *  platform does. \return true if the animation still exists afterwards.
+ */
+static bool animation_stop(Animation* animation, bool finished) {
+    animation->scheduled = false;
+    animation_unlink(animation);
+    if (animation->handlers.stopped)
+        animation->handlers.stopped(animation, finished, animation->context);
+    if (!object_alive(animation))
+        return false;
+#ifndef PBL_PLATFORM_APLITE
+    // SDK 3 platforms free animations once they stop.
+    object_destroy(animation);
+    return false;
+#else
+    return true;
+#endif
+}
+
+void animation_destroy(Animation* animation) {
+    if (!animation_check(animation, "animation_destroy"))
+        return;
+    if (animation->scheduled && !animation_stop(animation, false))
+        return;
+    if (object_alive(animation))
+        object_destroy(animation);
+}
+
+void property_animation_destroy(PropertyAnimation* animation) {
+    animation_destroy(animation);
+}
+
+void animation_set_duration(Animation* animation, uint32_t duration_ms) {
+    if (animation_check(animation, "animation_set_duration"))
+        animation->duration = duration_ms;
+}
+
+void animation_set_curve(Animation* animation, AnimationCurve curve) {
+    animation_check(animation, "animation_set_curve");
+}
+
+void animation_set_handlers(Animation* animation, AnimationHandlers handlers, void* context) {
+    if (!animation_check(animation, "animation_set_handlers"))
+        return;
+    animation->handlers = handlers;
+    animation->context = context;
+}
+
+void animation_schedule(Animation* animation) {
+    if (!animation_check(animation, "animation_schedule") || !layer_check(animation->layer, "animation_schedule"))
+        return;
+    if (!animation->hasFrom) animation->from = animation->layer->frame;
+    if (!animation->scheduled) {
+        animation->next = animations;
+        animations = animation;
+    }
+    animation->scheduled = true;
+    animation->start = stats.now;
+}
+
+static int16_t interpolate(int16_t from, int16_t to, uint32_t elapsed, uint32_t duration) {
+    return from + (int32_t)(to - from) * (int32_t)elapsed / (int32_t)duration;
+}
+
+static void run_animations(void) {
+    Animation* running[64];
+    int count = 0;
+    for (Animation* a = animations; a && count < 64; a = a->next) running[count++] = a;
+    for (int i = 0; i < count; ++i) {
+        Animation* a = running[i];
+        // An earlier stopped handler may have destroyed or stopped it.
+        if (!object_alive(a) || !a->scheduled)
+            continue;
+        uint32_t elapsed = stats.now - a->start;
+        if (elapsed > a->duration) elapsed = a->duration;
+        if (!layer_check(a->layer, "animation frame (animated layer destroyed)")) {
+            animation_stop(a, false);
+            continue;
+        }
+        uint32_t duration = a->duration ? a->duration : 1;
+        a->layer->frame = GRect(
+            interpolate(a->from.origin.x, a->to.origin.x, elapsed, duration),
+            interpolate(a->from.origin.y, a->to.origin.y, elapsed, duration),
+            interpolate(a->from.size.w, a->to.size.w, elapsed, duration),
+            interpolate(a->from.size.h, a->to.size.h, elapsed, duration));
+        dirty = true;
+        if (elapsed >= a->duration)
+            animation_stop(a, true);
+    }
+}
+
+/* Timers. */
+
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void* data) {
+    AppTimer* timer = object_create(FAKE_TIMER, sizeof(AppTimer));
+    timer->due = stats.now + timeout_ms;
+    timer->callback = callback;
+    timer->data = data;
+    timer->next = timers;
+    timers = timer;
+    return timer;
+}
+
+static void timer_release(AppTimer* timer) {
+    AppTimer** link = &timers;
+    while (*link && *link != timer) link = &(*link)->next;
+    if (*link) *link = timer->next;
+    object_destroy(timer);
+}
+
+void app_timer_cancel(AppTimer* timer) {
+    if (object_check(timer, FAKE_TIMER, "app_timer_cancel"))
+        timer_release(timer);
+}
+
+static void run_timers(void) {
+    AppTimer* timer = timers;
+    while (timer) {
+        if (timer->due > stats.now) {
+            timer = timer->next;
+            continue;
+        }
+        // The timer is gone before its callback runs, as on the watch.
+        AppTimerCallback callback = timer->callback;
+        void* data = timer->data;
+        timer_release(timer);
+        energy()->wakeups++;
+        callback(data);
+        timer = timers;
+    }
+}
+
+void fake_advance(uint32_t ms) {
+    do {
+        uint32_t step = (ms < FRAME_MS) ? ms : FRAME_MS;
+        energy()->ms += step;
+        if ((stats.now + step) / MINUTE_MS != stats.now / MINUTE_MS) minuteTick = true;
+        stats.now += step;
+        ms -= step;
+        run_animations();
+        run_timers();
+        render();
+    } while (ms);
+}
+
+/* Fonts, resources and services. */
+
+GFont fonts_get_system_font(const char* font_key) {
+    return &systemFont;
+}
+
+GFont fonts_load_custom_font(ResHandle handle) {
+    return object_create(FAKE_FONT, sizeof(struct FakeFont));
+}
+
+void fonts_unload_custom_font(GFont font) {
+    if (font != &systemFont && object_check(font, FAKE_FONT, "fonts_unload_custom_font"))
+        object_destroy(font);
+}
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+    return resource_id;
+}
+
+size_t resource_load_byte_range(ResHandle handle, uint32_t start_offset, uint8_t* buffer, size_t num_bytes) {
+    static uint8_t* tutorial = NULL;
+    static size_t tutorialSize = 0;
+    if (handle != RESOURCE_ID_TUTORIAL) {
+        fake_error("resource_load_byte_range: unknown resource %u", handle);
+        return 0;
+    }
+    if (!tutorial) {
+        FILE* f = fopen(TUTORIAL_BIN, "rb");
+        if (!f) {
+            fake_error("resource_load_byte_range: can't open %s", TUTORIAL_BIN);
+            return 0;
+        }
+        fseek(f, 0, SEEK_END);
+        tutorialSize = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        tutorial = malloc(tutorialSize);
+        tutorialSize = fread(tutorial, 1, tutorialSize, f);
+        fclose(f);
+    }
+    size_t length = (start_offset < tutorialSize) ? tutorialSize - start_offset : 0;
+    if (length > num_bytes) length = num_bytes;
+    memcpy(buffer, tutorial + start_offset, length);
+    stats.resourceReads++;
+    stats.resourceBytes += length;
+    if (length > stats.maxResourceRead) stats.maxResourceRead = length;
+    return length;
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+    batteryHandler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+    batteryHandler = NULL;
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+    return battery;
+}
+
+void fake_set_battery(BatteryChargeState state) {
+    battery = state;
+    if (!batteryHandler)
+        return;
+    energy()->wakeups++;
+    batteryHandler(state);
+}
+
+bool persist_exists(uint32_t key) {
+    for (int i = 0; i < persistCount; ++i) {
+        if (persist[i].key == key) return true;
+    }
+    return false;
+}
+
+bool persist_read_bool(uint32_t key) {
+    for (int i = 0; i < persistCount; ++i) {
+        if (persist[i].key == key) return persist[i].value;
+    }
+    return false;
+}
+
+int persist_write_bool(uint32_t key, bool value) {
+    int i = 0;
+    while (i < persistCount && persist[i].key != key) ++i;
+    if (i == MAX_PERSIST) {
+        fake_error("persist_write_bool: too many keys");
+        return -1;
+    }
+    if (i == persistCount) persistCount++;
+    persist[i].key = key;
+    persist[i].value = value;
+    return sizeof(bool);
+}
+
+void vibes_short_pulse(void) {
+    stats.vibes++;
+}
+
+void vibes_double_pulse(void) {
+    stats.vibes++;
+}
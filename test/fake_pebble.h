@@ -0,0 +1,100 @@
+/** \file   fake_pebble.h
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ *
+ *  Controls for the fake Pebble API, used by the soak test to drive the app.
+ */
+
+#ifndef FAKE_PEBBLE_CONTROL_H
+#define FAKE_PEBBLE_CONTROL_H
+
+#include "pebble.h"
+
+typedef enum {FAKE_HEAP, FAKE_LAYER, FAKE_WINDOW, FAKE_ANIMATION, FAKE_BITMAP, FAKE_TIMER, FAKE_FONT, FAKE_KINDS} FakeKind;
+
+/** Frames drawn for one reason, and the drawing work they did. */
+typedef struct {
+    unsigned long frames;
+    unsigned long textLayouts;
+    unsigned long fills;
+    unsigned long bitmapDraws;
+} FakeFrames;
+
+/** What woke the watch while the app was in one power mode. */
+typedef struct {
+    uint32_t ms;
+    // Button, timer, battery and clock events handed to the app.
+    unsigned long wakeups;
+    // The faction cards sliding.
+    FakeFrames slide;
+    // The "press again to exit" message on the game window.
+    FakeFrames exitToast;
+    // Other animations, such as the selection box moving.
+    FakeFrames animation;
+    // The status bar clock changing and nothing else.
+    FakeFrames statusBar;
+    // Redraws after a button, timer or battery event.
+    FakeFrames input;
+} FakeEnergy;
+
+typedef struct {
+    uint32_t now;
+    unsigned long frames;
+    unsigned long textLayouts;
+    unsigned long fills;
+    unsigned long bitmapDraws;
+    unsigned long captures;
+    // Frames drawn on the faction menu while its cards are sliding.
+    unsigned long slideFrames;
+    unsigned long slideTextLayouts;
+    unsigned long slideFills;
+    unsigned long slideBitmapDraws;
+    unsigned long resourceReads;
+    unsigned long resourceBytes;
+    size_t maxResourceRead;
+    unsigned long vibes;
+    size_t heapBytes;
+    size_t peakHeapBytes;
+    int peakLayers;
+    int peakAnimations;
+    // Indexed by the app's low power state, see fake_set_power_probe.
+    FakeEnergy energy[2];
+} FakeStats;
+
+/** Presses a button on the top window, held for a long click if held is true.
+ *  BACK pops the top window unless the window subscribes to it.
+ */
+void fake_press(ButtonId button, bool held);
+
+/** Moves the clock forward, running animations, timers and redraws frame by frame. */
+void fake_advance(uint32_t ms);
+
+/** Reports a new battery state to the app. */
+void fake_set_battery(BatteryChargeState state);
+
+/** Sets the function asked whether the app is in low power mode, used to split FakeStats.energy. */
+void fake_set_power_probe(bool (*isLow)(void));
+
+/** \return The number of windows on the stack. */
+int fake_stack_depth(void);
+
+/** \return The number of objects of the given kind that have not been destroyed. */
+int fake_live(FakeKind kind);
+
+/** \return true if the app is still subscribed to the battery service. */
+bool fake_battery_subscribed(void);
+
+/** \return The number of API misuses found so far, each is printed when found. */
+int fake_errors(void);
+
+/** Records an API misuse or failed check. */
+void fake_error(const char* fmt, ...);
+
+const FakeStats* fake_stats(void);
+
+/** \return The most heap in use since the last call, then starts a new measurement. */
+size_t fake_take_heap_peak(void);
+
+const char* fake_kind_name(FakeKind kind);
+
+#endif
@@ -0,0 +1,234 @@
+/** \file   pebble.h
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ *
+ *  A small fake of the Pebble SDK used to build the app on the host for the soak test.
+ *  Only the parts of the API the app uses are provided. Every object is tracked so the
+ *  soak test can report leaks and catch use of destroyed layers, animations and bitmaps.
+ */
+
+#ifndef FAKE_PEBBLE_H
+#define FAKE_PEBBLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Geometry.
+typedef struct { int16_t x, y; } GPoint;
+typedef struct { int16_t w, h; } GSize;
+typedef struct { GPoint origin; GSize size; } GRect;
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GPointZero GPoint(0, 0)
+#define GRectZero GRect(0, 0, 0, 0)
+
+// Colors, only the values the app uses, each distinct.
+typedef union { uint8_t argb; } GColor;
+#define GColorClearARGB8 0x00
+#define GColorBlackARGB8 0xC0
+#define GColorOxfordBlueARGB8 0xC1
+#define GColorDukeBlueARGB8 0xC2
+#define GColorBlueARGB8 0xC3
+#define GColorMidnightGreenARGB8 0xC5
+#define GColorKellyGreenARGB8 0xD8
+#define GColorDarkGrayARGB8 0xD5
+#define GColorImperialPurpleARGB8 0xD1
+#define GColorBulgarianRoseARGB8 0xD0
+#define GColorInchwormARGB8 0xED
+#define GColorDarkCandyAppleRedARGB8 0xE0
+#define GColorLightGrayARGB8 0xEA
+#define GColorRedARGB8 0xF0
+#define GColorSunsetOrangeARGB8 0xF5
+#define GColorChromeYellowARGB8 0xF8
+#define GColorYellowARGB8 0xFC
+#define GColorWhiteARGB8 0xFF
+#define GColorClear ((GColor){GColorClearARGB8})
+#define GColorBlack ((GColor){GColorBlackARGB8})
+#define GColorOxfordBlue ((GColor){GColorOxfordBlueARGB8})
+#define GColorDukeBlue ((GColor){GColorDukeBlueARGB8})
+#define GColorBlue ((GColor){GColorBlueARGB8})
+#define GColorMidnightGreen ((GColor){GColorMidnightGreenARGB8})
+#define GColorKellyGreen ((GColor){GColorKellyGreenARGB8})
+#define GColorDarkGray ((GColor){GColorDarkGrayARGB8})
+#define GColorImperialPurple ((GColor){GColorImperialPurpleARGB8})
+#define GColorBulgarianRose ((GColor){GColorBulgarianRoseARGB8})
+#define GColorInchworm ((GColor){GColorInchwormARGB8})
+#define GColorDarkCandyAppleRed ((GColor){GColorDarkCandyAppleRedARGB8})
+#define GColorLightGray ((GColor){GColorLightGrayARGB8})
+#define GColorRed ((GColor){GColorRedARGB8})
+#define GColorSunsetOrange ((GColor){GColorSunsetOrangeARGB8})
+#define GColorChromeYellow ((GColor){GColorChromeYellowARGB8})
+#define GColorYellow ((GColor){GColorYellowARGB8})
+#define GColorWhite ((GColor){GColorWhiteARGB8})
+
+typedef enum { GCornerNone = 0, GCornersAll = 0xF } GCornerMask;
+typedef enum { GTextOverflowModeWordWrap, GTextOverflowModeTrailingEllipsis, GTextOverflowModeFill } GTextOverflowMode;
+typedef enum { GTextAlignmentLeft, GTextAlignmentCenter, GTextAlignmentRight } GTextAlignment;
+typedef enum { GBitmapFormat1Bit, GBitmapFormat8Bit } GBitmapFormat;
+typedef enum { AnimationCurveLinear, AnimationCurveEaseIn, AnimationCurveEaseOut, AnimationCurveEaseInOut } AnimationCurve;
+typedef enum { BUTTON_ID_BACK, BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN, NUM_BUTTONS } ButtonId;
+typedef enum { APP_LOG_LEVEL_ERROR = 1, APP_LOG_LEVEL_WARNING = 50, APP_LOG_LEVEL_INFO = 100 } AppLogLevel;
+
+#define STATUS_BAR_LAYER_HEIGHT 16
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+
+enum {
+    RESOURCE_ID_GAME_SYMBOLS_46 = 1,
+    RESOURCE_ID_GAME_SYMBOLS_40,
+    RESOURCE_ID_CIND_46,
+    RESOURCE_ID_CIND_20,
+    RESOURCE_ID_TUTORIAL,
+};
+
+// Opaque handles, defined in fake_pebble.c.
+typedef struct Layer Layer;
+typedef struct TextLayer TextLayer;
+typedef struct StatusBarLayer StatusBarLayer;
+typedef struct Window Window;
+typedef struct Animation Animation;
+typedef struct Animation PropertyAnimation;
+typedef struct GBitmap GBitmap;
+typedef struct GContext GContext;
+typedef struct AppTimer AppTimer;
+typedef struct FakeFont* GFont;
+typedef void* ClickRecognizerRef;
+typedef uint32_t ResHandle;
+
+typedef void (*LayerUpdateProc)(Layer* layer, GContext* ctx);
+typedef void (*WindowHandler)(Window* window);
+typedef struct {
+    WindowHandler load;
+    WindowHandler appear;
+    WindowHandler disappear;
+    WindowHandler unload;
+} WindowHandlers;
+typedef void (*ClickHandler)(ClickRecognizerRef recognizer, void* context);
+typedef void (*ClickConfigProvider)(void* context);
+typedef void (*AnimationStartedHandler)(Animation* animation, void* context);
+typedef void (*AnimationStoppedHandler)(Animation* animation, bool finished, void* context);
+typedef struct {
+    AnimationStartedHandler started;
+    AnimationStoppedHandler stopped;
+} AnimationHandlers;
+typedef void (*AppTimerCallback)(void* data);
+typedef struct {
+    uint8_t charge_percent;
+    bool is_charging;
+    bool is_plugged;
+} BatteryChargeState;
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+
+#define APP_LOG(level, fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+
+// Layers.
+Layer* layer_create(GRect frame);
+Layer* layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer* layer);
+void* layer_get_data(const Layer* layer);
+GRect layer_get_frame(const Layer* layer);
+GRect layer_get_bounds(const Layer* layer);
+void layer_set_frame(Layer* layer, GRect frame);
+void layer_set_update_proc(Layer* layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer* parent, Layer* child);
+void layer_insert_below_sibling(Layer* layer, Layer* below);
+void layer_remove_from_parent(Layer* layer);
+void layer_mark_dirty(Layer* layer);
+void layer_set_hidden(Layer* layer, bool hidden);
+
+TextLayer* text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer* text_layer);
+Layer* text_layer_get_layer(TextLayer* text_layer);
+void text_layer_set_text(TextLayer* text_layer, const char* text);
+void text_layer_set_font(TextLayer* text_layer, GFont font);
+void text_layer_set_text_color(TextLayer* text_layer, GColor color);
+void text_layer_set_background_color(TextLayer* text_layer, GColor color);
+void text_layer_set_text_alignment(TextLayer* text_layer, GTextAlignment alignment);
+void text_layer_set_overflow_mode(TextLayer* text_layer, GTextOverflowMode mode);
+
+StatusBarLayer* status_bar_layer_create(void);
+void status_bar_layer_destroy(StatusBarLayer* status_bar);
+Layer* status_bar_layer_get_layer(StatusBarLayer* status_bar);
+
+// Windows and clicks.
+Window* window_create(void);
+void window_destroy(Window* window);
+Layer* window_get_root_layer(const Window* window);
+void window_set_window_handlers(Window* window, WindowHandlers handlers);
+void window_set_click_config_provider(Window* window, ClickConfigProvider provider);
+void window_set_click_config_provider_with_context(Window* window, ClickConfigProvider provider, void* context);
+void window_set_background_color(Window* window, GColor color);
+bool window_is_loaded(Window* window);
+void window_stack_push(Window* window, bool animated);
+Window* window_stack_remove(Window* window, bool animated);
+void window_single_click_subscribe(ButtonId button, ClickHandler handler);
+void window_long_click_subscribe(ButtonId button, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler);
+ButtonId click_recognizer_get_button_id(ClickRecognizerRef recognizer);
+
+// Animations.
+PropertyAnimation* property_animation_create_layer_frame(Layer* layer, GRect* from_frame, GRect* to_frame);
+void property_animation_destroy(PropertyAnimation* property_animation);
+void animation_destroy(Animation* animation);
+void animation_set_duration(Animation* animation, uint32_t duration_ms);
+void animation_set_curve(Animation* animation, AnimationCurve curve);
+void animation_set_handlers(Animation* animation, AnimationHandlers handlers, void* context);
+void animation_schedule(Animation* animation);
+
+// Graphics.
+void graphics_context_set_fill_color(GContext* ctx, GColor color);
+void graphics_context_set_stroke_color(GContext* ctx, GColor color);
+void graphics_context_set_text_color(GContext* ctx, GColor color);
+void graphics_context_set_stroke_width(GContext* ctx, uint8_t stroke_width);
+void graphics_fill_rect(GContext* ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_round_rect(GContext* ctx, GRect rect, uint16_t radius);
+void graphics_fill_circle(GContext* ctx, GPoint p, uint16_t radius);
+void graphics_draw_circle(GContext* ctx, GPoint p, uint16_t radius);
+void graphics_draw_text(GContext* ctx, const char* text, GFont font, GRect box,
+        GTextOverflowMode overflow_mode, GTextAlignment alignment, void* layout);
+GSize graphics_text_layout_get_content_size(const char* text, GFont font, GRect box,
+        GTextOverflowMode overflow_mode, GTextAlignment alignment);
+void graphics_draw_bitmap_in_rect(GContext* ctx, const GBitmap* bitmap, GRect rect);
+GBitmap* graphics_capture_frame_buffer(GContext* ctx);
+bool graphics_release_frame_buffer(GContext* ctx, GBitmap* buffer);
+
+GBitmap* gbitmap_create_blank(GSize size, GBitmapFormat format);
+void gbitmap_destroy(GBitmap* bitmap);
+uint8_t* gbitmap_get_data(const GBitmap* bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap* bitmap);
+GBitmapFormat gbitmap_get_format(const GBitmap* bitmap);
+
+// Fonts and resources.
+GFont fonts_get_system_font(const char* font_key);
+GFont fonts_load_custom_font(ResHandle handle);
+void fonts_unload_custom_font(GFont font);
+ResHandle resource_get_handle(uint32_t resource_id);
+size_t resource_load_byte_range(ResHandle handle, uint32_t start_offset, uint8_t* buffer, size_t num_bytes);
+
+// Services.
+AppTimer* app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void* data);
+void app_timer_cancel(AppTimer* timer);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+BatteryChargeState battery_state_service_peek(void);
+bool persist_exists(uint32_t key);
+bool persist_read_bool(uint32_t key);
+int persist_write_bool(uint32_t key, bool value);
+void vibes_short_pulse(void);
+void vibes_double_pulse(void);
+void app_event_loop(void);
+
+// The app's heap, tracked so leaks and peak usage can be reported.
+void* fake_malloc(size_t size);
+void* fake_calloc(size_t count, size_t size);
+void fake_free(void* ptr);
+#ifndef FAKE_PEBBLE_IMPL
+#define malloc(size) fake_malloc(size)
+#define calloc(count, size) fake_calloc(count, size)
+#define free(ptr) fake_free(ptr)
+#endif
+
+#endif
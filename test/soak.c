@@ -0,0 +1,262 @@
+/** \file   soak.c
+ *  \author Dominic Shelton
+ *  \date   19-10-2026
+ *
+ *  Randomized soak test. Runs the app against the fake Pebble API over and over,
+ *  firing random presses, long presses, delays and battery changes, and checks that
+ *  every session ends with no layers, animations, timers, bitmaps or heap left behind.
+ *  Also estimates the energy each game costs in normal and low power mode, and measures
+ *  each tutorial step the game window loads.
+ *
+ *  Built with SOAK_LOW_BATTERY the battery is always low, so every game runs in low power mode.
+ *
+ *  Usage: soak [events] [seed]
+ */
+
+#define FAKE_PEBBLE_IMPL
+#include "fake_pebble.h"
+#include "../src/power.h"
+#include "../src/tutorial.h"
+#include <time.h>
+
+// console.anr.c is built with main renamed so the soak test can run it repeatedly.
+#undef main
+int app_main(void);
+
+#define MAX_SESSION_EVENTS 4000
+#define MAX_EXIT_PRESSES 20
+#define MAX_TUTORIAL_STEPS 64
+// Chance in 100 of pressing the button a tutorial step waits for, so games get through it.
+#define TUTORIAL_FOLLOW_PERCENT 50
+
+// Rough energy model. Every frame wakes the CPU to draw and pushes it to the display,
+// and every event wakes the CPU to run a handler. Drawing work is added on top.
+#define FRAME_ACTIVE_MS 4.0
+#define WAKEUP_ACTIVE_MS 1.0
+#define TEXT_LAYOUT_MS 0.8
+#define FILL_MS 0.1
+#define BITMAP_DRAW_MS 0.3
+
+static uint64_t rng;
+static unsigned long eventsLeft;
+static unsigned long sessions = 0;
+
+// Linked with --wrap so every tutorial call from the game window comes through here.
+int __real_tutorial_open(void);
+bool __real_tutorial_load_step(int index, TutorialStep* step);
+
+static struct {
+    bool active;
+    TutorialStep step;
+    unsigned long started;
+    unsigned long reached[MAX_TUTORIAL_STEPS];
+    unsigned long loads, reads, bytes, maxReads, maxBytes;
+    double hostUs, maxHostUs;
+} tutorial;
+
+// Heap high-water on the faction menu, in a game and in a game showing the tutorial.
+enum {PHASE_MENU, PHASE_GAME, PHASE_TUTORIAL, PHASES};
+static size_t phasePeak[PHASES];
+
+static uint32_t random_below(uint32_t n) {
+    // xorshift64*
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return (uint32_t)((rng * 0x2545F4914F6CDD1DULL) >> 32) % n;
+}
+
+int __wrap_tutorial_open(void) {
+    int steps = __real_tutorial_open();
+    tutorial.active = steps > 0;
+    if (steps) tutorial.started++;
+    return steps;
+}
+
+bool __wrap_tutorial_load_step(int index, TutorialStep* step) {
+    const FakeStats* s = fake_stats();
+    unsigned long reads = s->resourceReads, bytes = s->resourceBytes;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool loaded = __real_tutorial_load_step(index, step);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+    reads = s->resourceReads - reads;
+    bytes = s->resourceBytes - bytes;
+    tutorial.loads++;
+    tutorial.reads += reads;
+    tutorial.bytes += bytes;
+    tutorial.hostUs += us;
+    if (reads > tutorial.maxReads) tutorial.maxReads = reads;
+    if (bytes > tutorial.maxBytes) tutorial.maxBytes = bytes;
+    if (us > tutorial.maxHostUs) tutorial.maxHostUs = us;
+    tutorial.active = loaded;
+    if (loaded) {
+        tutorial.step = *step;
+        if (index < MAX_TUTORIAL_STEPS) tutorial.reached[index]++;
+    }
+    return loaded;
+}
+
+static int phase(void) {
+    if (fake_stack_depth() < 2)
+        return PHASE_MENU;
+    return tutorial.active ? PHASE_TUTORIAL : PHASE_GAME;
+}
+
+/** \return true if it pressed the button the current tutorial step waits for. */
+static bool follow_tutorial(void) {
+    uint8_t button = tutorial.step.button;
+    if (phase() != PHASE_TUTORIAL || button == TUTORIAL_BUTTON_NONE || random_below(100) >= TUTORIAL_FOLLOW_PERCENT)
+        return false;
+    fake_press(button & 0x0F, button & TUTORIAL_BUTTON_LONG);
+    return true;
+}
+
+static BatteryChargeState random_battery(void) {
+#ifdef SOAK_LOW_BATTERY
+    return (BatteryChargeState) {.charge_percent = random_below(3) * 10, .is_charging = false, .is_plugged = false};
+#else
+    return (BatteryChargeState) {
+        .charge_percent = random_below(11) * 10,
+        .is_charging = random_below(2),
+        .is_plugged = false,
+    };
+#endif
+}
+
+static void random_event(void) {
+    static const ButtonId buttons[] = {BUTTON_ID_UP, BUTTON_ID_SELECT, BUTTON_ID_DOWN};
+    uint32_t r = random_below(100);
+    if (r < 30) {
+        fake_press(buttons[random_below(3)], false);
+    }
+    else if (r < 36) {
+        fake_press(BUTTON_ID_BACK, false);
+    }
+    else if (r < 48) {
+        fake_press(buttons[random_below(3)], true);
+    }
+    else if (r < 95) {
+        // Mostly short gaps, so presses land in the middle of slides and exit messages.
+        fake_advance(random_below(10) ? random_below(400) : random_below(3000));
+    }
+    else {
+        fake_set_battery(random_battery());
+    }
+}
+
+/** Runs one session of the app, called from app_main in place of the real event loop. */
+void app_event_loop(void) {
+    unsigned long events = 1 + random_below(MAX_SESSION_EVENTS);
+    // Only count events that ran, a random BACK can end the session early.
+    while (events-- && eventsLeft && fake_stack_depth()) {
+        int p = phase();
+        fake_take_heap_peak();
+        if (!follow_tutorial())
+            random_event();
+        size_t peak = fake_take_heap_peak();
+        if (peak > phasePeak[p]) phasePeak[p] = peak;
+        // Only a new game can start the tutorial again.
+        if (fake_stack_depth() < 2) tutorial.active = false;
+        eventsLeft--;
+    }
+    // Leave the app the way a user would, BACK until the last window is gone.
+    for (int i = 0; i < MAX_EXIT_PRESSES && fake_stack_depth(); ++i) {
+        fake_press(BUTTON_ID_BACK, false);
+        fake_advance(100);
+    }
+    if (fake_stack_depth())
+        fake_error("session %lu: app did not exit with BACK", sessions);
+}
+
+static void check_session(void) {
+    for (FakeKind kind = 0; kind < FAKE_KINDS; ++kind) {
+        if (fake_live(kind))
+            fake_error("session %lu: leaked %d %s", sessions, fake_live(kind), fake_kind_name(kind));
+    }
+    if (fake_stats()->heapBytes)
+        fake_error("session %lu: leaked %zu heap bytes", sessions, fake_stats()->heapBytes);
+    if (fake_battery_subscribed())
+        fake_error("session %lu: still subscribed to the battery service", sessions);
+}
+
+static double per_frame(unsigned long count, unsigned long frames) {
+    return frames ? (double)count / frames : 0;
+}
+
+static double active_ms(const FakeFrames* f) {
+    return f->frames * FRAME_ACTIVE_MS + f->textLayouts * TEXT_LAYOUT_MS
+            + f->fills * FILL_MS + f->bitmapDraws * BITMAP_DRAW_MS;
+}
+
+/** Prints the refreshes and CPU time of an average length game spent in one power mode. */
+static void print_energy(const char* mode, const FakeEnergy* e, double gameMs) {
+    if (!e->ms) {
+        printf("  %s: never reached\n", mode);
+        return;
+    }
+    // Scale the totals for this mode to one game.
+    double scale = gameMs / e->ms;
+    const FakeFrames* reasons[] = {&e->slide, &e->exitToast, &e->animation, &e->statusBar, &e->input};
+    unsigned long refreshes = 0;
+    double active = e->wakeups * WAKEUP_ACTIVE_MS;
+    for (int i = 0; i < 5; ++i) {
+        refreshes += reasons[i]->frames;
+        active += active_ms(reasons[i]);
+    }
+    printf("  %s: %.1f hours, per game %.0f refreshes and ~%.0f ms CPU active (%.2f%% of the time)\n",
+            mode, e->ms / 3600000.0, refreshes * scale, active * scale, 100.0 * active / e->ms);
+    printf("    refreshes: %.1f slide (~%.0f ms), %.1f exit toast (~%.0f ms), %.1f status bar (~%.0f ms), "
+            "%.1f other animation, %.1f input, %.1f wakeups\n",
+            e->slide.frames * scale, active_ms(&e->slide) * scale,
+            e->exitToast.frames * scale, active_ms(&e->exitToast) * scale,
+            e->statusBar.frames * scale, active_ms(&e->statusBar) * scale,
+            e->animation.frames * scale, e->input.frames * scale, e->wakeups * scale);
+}
+
+int main(int argc, char** argv) {
+    unsigned long events = (argc > 1) ? strtoul(argv[1], NULL, 10) : 100000;
+    unsigned long seed = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1;
+    rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+    eventsLeft = events;
+    fake_set_power_probe(power_is_low);
+
+    while (eventsLeft && fake_errors() == 0) {
+#ifdef SOAK_LOW_BATTERY
+        fake_set_battery(random_battery());
+#endif
+        app_main();
+        check_session();
+        sessions++;
+    }
+
+    const FakeStats* s = fake_stats();
+    printf("%s: %lu events, %lu sessions, seed %lu, %.1f simulated hours\n",
+            PLATFORM_NAME, events - eventsLeft, sessions, seed, s->now / 3600000.0);
+    printf("  peak heap %zu bytes, peak %d layers, peak %d animations\n",
+            s->peakHeapBytes, s->peakLayers, s->peakAnimations);
+    printf("  %lu frames, %lu while cards slide: %.2f text layouts, %.2f fills, %.2f bitmaps per slide frame\n",
+            s->frames, s->slideFrames, per_frame(s->slideTextLayouts, s->slideFrames),
+            per_frame(s->slideFills, s->slideFrames), per_frame(s->slideBitmapDraws, s->slideFrames));
+    printf("  %lu card captures, %lu resource reads, %lu bytes read, largest read %zu bytes\n",
+            s->captures, s->resourceReads, s->resourceBytes, s->maxResourceRead);
+    double gameMs = sessions ? (double)s->now / sessions : 0;
+    unsigned long loads = tutorial.loads ? tutorial.loads : 1;
+    printf("  tutorial: %lu started, games reaching each step:", tutorial.started);
+    for (int i = 0; i < MAX_TUTORIAL_STEPS && tutorial.reached[i]; ++i)
+        printf(" %lu", tutorial.reached[i]);
+    printf("\n    per step load: %.2f reads and %.1f bytes (max %lu and %lu), %.2f us on the host (max %.1f)\n",
+            (double)tutorial.reads / loads, (double)tutorial.bytes / loads, tutorial.maxReads, tutorial.maxBytes,
+            tutorial.hostUs / loads, tutorial.maxHostUs);
+    printf("    peak heap %zu bytes with the tutorial, %zu in other games, %zu on the faction menu\n",
+            phasePeak[PHASE_TUTORIAL], phasePeak[PHASE_GAME], phasePeak[PHASE_MENU]);
+    printf("  energy, games average %.1f minutes:\n", gameMs / 60000.0);
+    print_energy("normal", &s->energy[0], gameMs);
+    print_energy("low power", &s->energy[1], gameMs);
+    if (fake_errors()) {
+        printf("  FAILED with %d errors\n", fake_errors());
+        return 1;
+    }
+    return 0;
+}
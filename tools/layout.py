@@ -0,0 +1,141 @@
+#
+# Generates the per-platform layout tables included as layout.auto.h.
+#
+# All screen geometry lives here so the C code only indexes precomputed
+# rects and never does layout arithmetic at runtime.
+#
+
+import math
+
+PLATFORMS = {
+    'aplite': {'width': 144, 'height': 168, 'status_bar': 0, 'round': False},
+    'basalt': {'width': 144, 'height': 168, 'status_bar': 16, 'round': False},
+    'chalk': {'width': 180, 'height': 180, 'status_bar': 24, 'round': True},
+}
+
+# Game screen, relative to the graphics layer below the status bar.
+MAX_CLICKS = 6
+CLICKS_Y = 19
+CLICKS_SIZE = (10 * 2) + 4
+CLICKS_X_OFFSET = 1
+CREDITS_Y = 49
+TURN_Y = 112
+TURN_HEIGHT = 30
+SELECT_0 = (14, 30)
+SELECT_1 = (58, 42)
+EXIT = (14, 66)
+TUTORIAL_HEIGHT = 56
+# Space between the tutorial box outline and its text.
+TUTORIAL_INSET = 4
+# Keep the tutorial text clear of the edge, further in on round screens.
+TUTORIAL_MARGIN = 2
+ROUND_TUTORIAL_MARGIN = 24
+
+# Faction cards, relative to the card.
+LOGO_Y = 25
+LOGO_HEIGHT = 100
+TEXT_HEIGHT = 50
+HB_TEXTHEIGHT = 20
+# Lift the name and drop the logos on round screens to keep them inside the circle.
+ROUND_NAME_LIFT = 12
+ROUND_LOGO_DROP = 6
+
+
+def fit_round(p, x, y, w, h):
+    """Shrinks a rect horizontally so its corners stay on a round screen."""
+    if not p['round']:
+        return (x, y, w, h)
+    r = p['width'] / 2.0
+    dy = max(abs(y - r), abs(y + h - r))
+    half = math.sqrt(max(r * r - dy * dy, 0))
+    inset = max(x, int(math.ceil(r - half)))
+    return (inset, y, p['width'] - 2 * inset, h)
+
+
+def overlaps(a, b):
+    return (b is not None and a[0] < b[0] + b[2] and b[0] < a[0] + a[2]
+            and a[1] < b[1] + b[3] and b[1] < a[1] + a[3])
+
+
+def rect(r):
+    return 'GRect({}, {}, {}, {})'.format(*r)
+
+
+def select_rects(platform):
+    """\return The clicks, credits and turn highlight rects."""
+    p = PLATFORMS[platform]
+    return [fit_round(p, 1, top + p['status_bar'], p['width'] - 2, height)
+            for top, height in (SELECT_0, SELECT_1, (TURN_Y, TURN_HEIGHT))]
+
+
+def tutorial_rects(platform):
+    """\return (region, rect) of the tutorial text for each TutorialRegion."""
+    p = PLATFORMS[platform]
+    w, h, bar = p['width'], p['height'], p['status_bar']
+    tutorial_margin = ROUND_TUTORIAL_MARGIN if p['round'] else TUTORIAL_MARGIN
+    # The status bar already keeps the top box off the edge of the screen.
+    tutorial_top = fit_round(p, 1, max(bar, tutorial_margin) + TUTORIAL_MARGIN, w - 2, TUTORIAL_HEIGHT)
+    tutorial_bottom = fit_round(p, 1, h - TUTORIAL_HEIGHT - tutorial_margin, w - 2, TUTORIAL_HEIGHT)
+    # Tutorial text for each TutorialRegion, at the bottom unless that covers the highlight.
+    tutorial = []
+    for region, highlight in zip(('NONE', 'CLICKS', 'CREDITS', 'TURN'), [None] + select_rects(platform)):
+        box = next((r for r in (tutorial_bottom, tutorial_top) if not overlaps(r, highlight)), None)
+        if box is None:
+            raise ValueError('{}: tutorial text covers the {} highlight'.format(platform, region.lower()))
+        tutorial.append((region, box))
+    return tutorial
+
+
+def generate(platform):
+    p = PLATFORMS[platform]
+    w, h, bar = p['width'], p['height'], p['status_bar']
+
+    def select(top, height):
+        return fit_round(p, 1, top + bar, w - 2, height)
+
+    select_0, select_1, select_turn = select_rects(platform)
+    exit_rect = select(*EXIT)
+    tutorial = [('LAYOUT_TUTORIAL_RECT_' + region, rect(box)) for region, box in tutorial_rects(platform)]
+    name = (0, h - TEXT_HEIGHT, w, TEXT_HEIGHT)
+    logo = (0, LOGO_Y, w, LOGO_HEIGHT)
+    if p['round']:
+        name = (0, name[1] - ROUND_NAME_LIFT, w, TEXT_HEIGHT)
+        logo = (0, LOGO_Y + ROUND_LOGO_DROP, w, LOGO_HEIGHT)
+
+    defines = [
+        ('LAYOUT_SCREEN_WIDTH', w),
+        ('LAYOUT_SCREEN_HEIGHT', h),
+        ('LAYOUT_HAS_STATUS_BAR', 1 if bar else 0),
+        ('LAYOUT_MAX_CLICKS', MAX_CLICKS),
+        ('LAYOUT_CLICKS_Y', CLICKS_Y),
+        ('LAYOUT_CREDITS_Y', CREDITS_Y),
+        ('LAYOUT_GRAPHICS_RECT', rect((0, bar, w, h - bar))),
+        ('LAYOUT_TURN_RECT', rect((0, TURN_Y, w, TURN_HEIGHT))),
+        ('LAYOUT_SELECT_RECT_0', rect(select_0)),
+        ('LAYOUT_SELECT_RECT_1', rect(select_1)),
+        ('LAYOUT_SELECT_RECT_TURN', rect(select_turn)),
+        ('LAYOUT_EXIT_RECT', rect(exit_rect)),
+        ('LAYOUT_EXIT_OUT_RECT', rect((exit_rect[0], bar - EXIT[1], exit_rect[2], EXIT[1]))),
+        ('LAYOUT_TUTORIAL_INSET', TUTORIAL_INSET),
+        ('LAYOUT_CARD_NAME_RECT', rect(name)),
+        # Corp names move down to make room for the two lines of logos.
+        ('LAYOUT_CARD_NAME_RECT_CORP', rect((0, name[1] + LOGO_Y // 2, w, TEXT_HEIGHT))),
+        # Haas-Bioroid moves up for its two line name.
+        ('LAYOUT_CARD_NAME_RECT_HAAS', rect((0, name[1] - HB_TEXTHEIGHT, w, TEXT_HEIGHT))),
+        ('LAYOUT_CARD_LOGO_RECT', rect(logo)),
+        ('LAYOUT_CARD_LOGO_RECT_CORP', rect((0, logo[1] - LOGO_Y // 2, w, LOGO_HEIGHT))),
+    ] + tutorial
+    # x position of the first click circle for each number of clicks shown.
+    clicks_x = [(w - t * CLICKS_SIZE) // 2 + CLICKS_X_OFFSET for t in range(MAX_CLICKS + 1)]
+
+    lines = ['/* Generated by tools/layout.py for {}, do not edit. */'.format(platform), '']
+    lines += ['#define {} {}'.format(k, v) for k, v in defines]
+    lines += ['', 'static const int16_t LAYOUT_CLICKS_X[LAYOUT_MAX_CLICKS + 1] = {{{}}};'.format(
+        ', '.join(str(x) for x in clicks_x)), '']
+    return '\n'.join(lines)
+
+
+if __name__ == '__main__':
+    import sys
+    for platform in sys.argv[1:] or sorted(PLATFORMS):
+        print(generate(platform))
@@ -0,0 +1,132 @@
+#
+# Compiles the tutorial script into resources/data/tutorial.bin.
+#
+# The wscript regenerates the resource on every build, run this directly to
+# write it somewhere else, e.g. for the soak test. The app streams one step at a time from the
+# resource, so the script can grow without using more RAM on the watch.
+#
+# Format, all values unsigned bytes unless noted:
+#   header  'T' 'U' 'T' version count 0
+#   offsets count little-endian uint16 offsets of each step
+#   step    button region flags avClicks totalClicks credits selected textLen text
+#
+
+import os
+import struct
+
+import layout
+
+VERSION = 1
+TEXT_LEN = 64
+
+# Buttons, matching ButtonId in pebble.h.
+BACK, UP, SELECT, DOWN = 0, 1, 2, 3
+LONG = 0x10     # The button must be held.
+CONSUME = 0x20  # The press only advances the tutorial and is not passed to the game.
+NONE = 0xFF     # The step waits for BACK.
+
+# Highlighted regions, matching TutorialRegion in tutorial.h.
+REGION_NONE, REGION_CLICKS, REGION_CREDITS, REGION_TURN = 0, 1, 2, 3
+
+# Selected values, matching VALUE_CLICKS and VALUE_CREDITS in gameWindow.c.
+CLICKS, CREDITS = 0, 1
+
+FLAG_SETUP = 0x01
+
+# Worst case GOTHIC_14_BOLD metrics, used to check each step fits its box on every platform.
+LINE_HEIGHT = 18
+NARROW, WIDE, CAPITAL, DEFAULT = 4, 11, 9, 7
+WIDTHS = dict([(c, 3) for c in "il.,:;!'|"] + [(' ', 4)] + [(c, NARROW) for c in 'fjrtI']
+              + [(c, WIDE) for c in 'mw'] + [(c, WIDE + 2) for c in 'MW'])
+
+# (text, button, region, setup) where setup is None or
+# (avClicks, totalClicks, credits, selected) applied before the step is shown.
+STEPS = [
+    ("Welcome! Learn to track a game. Press SELECT.",
+        SELECT | CONSUME, REGION_NONE, (4, 4, 5, CLICKS)),
+    ("Circles are clicks. Press DOWN to spend one.",
+        DOWN, REGION_CLICKS, (4, 4, 5, CLICKS)),
+    ("Spend your last click with DOWN to end your turn.",
+        DOWN, REGION_CLICKS, (1, 4, 5, CLICKS)),
+    ("Your turn ended and your clicks refilled. Press SELECT.",
+        SELECT | CONSUME, REGION_TURN, None),
+    ("Hold UP to gain an extra click every turn.",
+        UP | LONG, REGION_CLICKS, None),
+    ("Hold DOWN to remove it again.",
+        DOWN | LONG, REGION_CLICKS, None),
+    ("Press SELECT to move to your credits.",
+        SELECT, REGION_CLICKS, None),
+    ("Press UP to gain a credit.",
+        UP, REGION_CREDITS, None),
+    ("Press DOWN to spend a credit.",
+        DOWN, REGION_CREDITS, None),
+    ("Hold UP to gain five credits at once.",
+        UP | LONG, REGION_CREDITS, None),
+    ("Hold DOWN to spend five.",
+        DOWN | LONG, REGION_CREDITS, None),
+    ("That's it! Press BACK twice to leave the tutorial.",
+        NONE, REGION_NONE, None),
+]
+
+
+def text_width(text):
+    return sum(WIDTHS.get(c, CAPITAL if c.isupper() else DEFAULT) for c in text)
+
+
+def wrap(text, width):
+    """\return The lines of text word wrapped to width pixels."""
+    lines = ['']
+    for word in text.split():
+        line = (lines[-1] + ' ' + word).strip()
+        if text_width(line) <= width or not lines[-1]:
+            lines[-1] = line
+        else:
+            lines.append(word)
+    return lines
+
+
+def check_fits(text, region):
+    """Raises if the text could overflow its tutorial box on any platform."""
+    for platform in sorted(layout.PLATFORMS):
+        x, y, w, h = layout.tutorial_rects(platform)[region][1]
+        lines = wrap(text, w - 2 * layout.TUTORIAL_INSET)
+        if max(text_width(line) for line in lines) > w - 2 * layout.TUTORIAL_INSET or len(lines) * LINE_HEIGHT > h:
+            raise ValueError('{}: step text needs {} lines in a {}x{} box: {}'.format(platform, len(lines), w, h, text))
+
+
+def compile_steps(steps):
+    header = struct.pack('<3sBBB', b'TUT', VERSION, len(steps), 0)
+    body = b''
+    offsets = []
+    start = len(header) + 2 * len(steps)
+    for text, button, region, setup in steps:
+        text = text.encode('ascii')
+        if len(text) > TEXT_LEN:
+            raise ValueError('Step text is longer than {} characters: {}'.format(TEXT_LEN, text))
+        check_fits(text.decode('ascii'), region)
+        flags = FLAG_SETUP if setup else 0
+        offsets.append(start + len(body))
+        body += struct.pack('<8B', button, region, flags, *(list(setup or (0, 0, 0, 0)) + [len(text)]))
+        body += text
+    return header + struct.pack('<{}H'.format(len(steps)), *offsets) + body
+
+
+def write(path):
+    """Writes the compiled steps to path, leaving it untouched if nothing changed."""
+    data = compile_steps(STEPS)
+    # The directory only holds this generated file, so it is missing from a fresh clone.
+    directory = os.path.dirname(path)
+    if directory and not os.path.isdir(directory):
+        os.makedirs(directory)
+    if os.path.exists(path):
+        with open(path, 'rb') as f:
+            if f.read() == data:
+                return
+    with open(path, 'wb') as f:
+        f.write(data)
+
+
+if __name__ == '__main__':
+    import sys
+    write(sys.argv[1] if len(sys.argv) > 1 else
+          os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'resources', 'data', 'tutorial.bin'))